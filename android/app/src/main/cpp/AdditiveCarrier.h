@@ -0,0 +1,296 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+/**
+ * Carrier sintetizado directamente por bandas (resíntese aditiva).
+ *
+ * En lugar de filtrar unha serra de banda completa, cada banda xera os
+ * kPartialsPerBand harmónicos do pitch máis próximos á súa frecuencia
+ * central, coa amplitude que terían á saída do pasa-banda (resposta RBJ
+ * por espectro harmónico h^-tilt). A enerxía dos harmónicos que quedan
+ * fóra compénsase escalando os parciais, así que o balance entre bandas
+ * é o do banco de filtros.
+ *
+ * Os osciladores son recursivos (s[n] = 2cos(w) s[n-1] - s[n-2]) e o
+ * peso de cada parcial vai na amplitude do propio estado: por mostra
+ * só custan unha multiplicación e unha resta, fronte ás cinco
+ * multiplicacións e catro sumas dunha biquad do banco de filtros. En
+ * cada bloque de control o estado reescálase á nova amplitude coa nova
+ * frecuencia; todo está en formato SoA e sen dependencias entre
+ * parciais, para que os bucles se vectoricen.
+ *
+ * Cando o pitch só se move un pouco (vibrato, portamento), o paso de
+ * cada banda obtense rotando o do bloque anterior en lugar de con
+ * sin/cos: só se calculan exactos os harmónicos que saltan máis dunha
+ * posición e unha banda por update(), por quendas, para que o erro da
+ * rotación non se acumule.
+ *
+ * Interface de saída igual ao banco de filtros do carrier: unha mostra
+ * por banda.
+ */
+template <int NumBands> class AdditiveCarrier {
+public:
+  static constexpr int kPartialsPerBand = 2;
+  static constexpr int kNumPartials = NumBands * kPartialsPerBand;
+  static constexpr int kMaxHarmonic = 512;
+
+  AdditiveCarrier(float sampleRate) : mSampleRate(sampleRate) {
+    for (int h = 1; h <= kMaxHarmonic; h++) {
+      mInvHarmonic[h] = 1.0f / h;
+      mLogHarmonic[h] = std::log(static_cast<float>(h));
+    }
+    setTilt(1.0f);
+    reset();
+  }
+
+  void reset() {
+    mS1.fill(0.0f);
+    mS2.fill(0.0f);
+    mCoeff.fill(0.0f);
+    mFirst.fill(0);
+    mLastPitch = 0.0f;
+    mLastFirstBand = 0.0f;
+    mLastW0 = 0.0f;
+    mStepCos = 1.0f;
+    mStepSin = 0.0f;
+    mExactBand = 0;
+  }
+
+  // 0 = todos os harmónicos iguais, 1 = espectro de serra, 2 = máis escuro
+  void setTilt(float tilt) {
+    tilt = std::clamp(tilt, 0.0f, 2.0f);
+    if (tilt == mTilt)
+      return;
+    mTilt = tilt;
+    // Amplitude do harmónico h: 2/pi * h^-tilt (2/pi / h para a serra)
+    for (int h = 1; h <= kMaxHarmonic; h++)
+      mSpectrum[h] = 0.6366f * std::exp(-mTilt * mLogHarmonic[h]);
+    mLastPitch = 0.0f;
+  }
+
+  /**
+   * Recalcula os parciais (unha vez por bloque de control).
+   * bandFreqs: frecuencias centrais en orde ascendente (xa desprazadas
+   * polo formante).
+   */
+  VOCODER_ALWAYS_INLINE void update(float pitch, const float *bandFreqs,
+                                    float q) {
+    // Pitch e formante iguais: o estado xa ten a amplitude correcta
+    if (pitch == mLastPitch && bandFreqs[0] == mLastFirstBand)
+      return;
+    if (bandFreqs[0] != mLastFirstBand) {
+      for (int band = 0; band < NumBands; band++)
+        mInvBandFreq[band] = 1.0f / bandFreqs[band];
+    }
+    mLastPitch = pitch;
+    mLastFirstBand = bandFreqs[0];
+
+    assignHarmonics(pitch, bandFreqs);
+
+    // Peso de cada parcial: espectro * resposta do pasa-banda
+    const float nyquistLimit = mSampleRate * 0.45f;
+    const float q2 = q * q;
+    for (int p = 0; p < kNumPartials; p++) {
+      float freq = mHarmonic[p] * pitch;
+      float detune = freq * mInvCentre[p] -
+                     mRatio[p] * mInvHarmonic[mHarmonic[p]];
+      float w = mSpectrum[mHarmonic[p]] /
+                std::sqrt(1.0f + q2 * detune * detune);
+      mTarget[p] = freq < nyquistLimit ? w : 0.0f;
+    }
+
+    // Con máis dun harmónico por ancho de banda, os parciais levan a
+    // potencia da serra a través do pasa-banda (ancho de ruído
+    // equivalente: pi/2 * fc/Q)
+    for (int band = 0; band < NumBands; band++) {
+      float power = 0.0f;
+      for (int slot = 0; slot < kPartialsPerBand; slot++) {
+        float w = mTarget[slot * NumBands + band];
+        power += w * w;
+      }
+      float ratio = mRatio[band];
+      float dense = 0.0f;
+      if (bandFreqs[band] < nyquistLimit && ratio > q) {
+        float amplitude = mSpectrum[std::min(static_cast<int>(ratio),
+                                             kMaxHarmonic)];
+        dense = amplitude * amplitude * 1.5708f * ratio / q;
+      }
+      float scale = power > 1e-12f ? std::sqrt(std::max(power, dense) / power)
+                                   : 0.0f;
+      for (int slot = 0; slot < kPartialsPerBand; slot++)
+        mTarget[slot * NumBands + band] *= scale;
+    }
+
+    // Reescalar o estado: amplitude actual coa nova frecuencia,
+    //   A^2 = (s1^2 + s2^2 - 2 c s1 s2) / sin^2(w)
+    // que corrixe tamén a deriva numérica da recursión. Un parcial
+    // parado (A ~ 0) arranca en fase 0: s1 = 0, s2 = -A sin(w)
+    for (int p = 0; p < kNumPartials; p++) {
+      float c = mNewCos[p];
+      float s = mNewSin[p];
+      float s1 = mS1[p];
+      float s2 = mS2[p];
+      float energy = s1 * s1 + s2 * s2 - 2.0f * c * s1 * s2;
+      float sin2 = std::max(s * s, 1e-8f);
+      bool running = energy > 1e-12f * sin2;
+      float gain = mTarget[p] * std::sqrt(sin2 / std::max(energy, 1e-30f));
+      mS1[p] = running ? s1 * gain : 0.0f;
+      mS2[p] = running ? s2 * gain : -mTarget[p] * s;
+      mCoeff[p] = 2.0f * c;
+    }
+  }
+
+  // Unha mostra por banda en output[NumBands]
+  VOCODER_ALWAYS_INLINE void process(float *output) {
+    for (int p = 0; p < kNumPartials; p++) {
+      float s = mCoeff[p] * mS1[p] - mS2[p];
+      mS2[p] = mS1[p];
+      mS1[p] = s;
+    }
+    for (int band = 0; band < NumBands; band++) {
+      float sum = mS1[band];
+      for (int slot = 1; slot < kPartialsPerBand; slot++)
+        sum += mS1[slot * NumBands + band];
+      output[band] = sum;
+    }
+  }
+
+private:
+  // Xiro máximo (radiáns) que se aplica por rotación; a serie de Taylor
+  // de 5ª orde ten aí un erro por baixo de 1e-9
+  static constexpr float kMaxRotation = 0.1f;
+
+  float mSampleRate;
+  float mTilt = -1.0f;
+  float mLastPitch = 0.0f;
+  float mLastFirstBand = 0.0f;
+  std::array<float, kMaxHarmonic + 1> mSpectrum{};
+  std::array<float, kMaxHarmonic + 1> mInvHarmonic{};
+  std::array<float, kMaxHarmonic + 1> mLogHarmonic{};
+
+  // Parcial p = slot * NumBands + banda. Estado s[n-1], s[n-2] e
+  // 2cos(w) da recursión
+  std::array<float, kNumPartials> mS1{};
+  std::array<float, kNumPartials> mS2{};
+  std::array<float, kNumPartials> mCoeff{};
+
+  // Resultados intermedios de update()
+  std::array<float, kNumPartials> mNewCos{};
+  std::array<float, kNumPartials> mNewSin{};
+  std::array<float, kNumPartials> mTarget{};
+  std::array<int, kNumPartials> mHarmonic{};
+  std::array<float, kNumPartials> mInvCentre{};
+  std::array<float, kNumPartials> mRatio{}; // centro / pitch
+  std::array<float, NumBands> mInvBandFreq{};
+
+  // Primeiro harmónico de cada banda (0 = sen calcular) e cos/sin do seu
+  // paso por mostra co w0 do último update()
+  std::array<int, NumBands> mFirst{};
+  std::array<float, NumBands> mFirstCos{};
+  std::array<float, NumBands> mFirstSin{};
+  std::array<float, NumBands> mBandRatio{};
+  float mLastW0 = 0.0f;
+  float mStepCos = 1.0f; // cos/sin(w0)
+  float mStepSin = 0.0f;
+  int mExactBand = 0; // Banda que se recalcula exacta neste update()
+
+  // Rota (c, s) un ángulo pequeno (|angle| <= kMaxRotation) por Taylor
+  // e devólveo ao círculo unidade: co pitch baixo, un erro de norma en c
+  // xa sería un erro de frecuencia audible
+  static VOCODER_ALWAYS_INLINE void rotate(float &c, float &s, float angle) {
+    float a2 = angle * angle;
+    float rc = 1.0f - a2 * (0.5f - a2 * (1.0f / 24.0f));
+    float rs = angle * (1.0f - a2 * (1.0f / 6.0f - a2 * (1.0f / 120.0f)));
+    float next = c * rc - s * rs;
+    s = s * rc + c * rs;
+    c = next;
+    float norm = 1.5f - 0.5f * (c * c + s * s);
+    c *= norm;
+    s *= norm;
+  }
+
+  /**
+   * Escolle os harmónicos de cada banda e o seu paso por mostra. O do
+   * primeiro harmónico sae do update() anterior rotado polo cambio de
+   * pitch (e un harmónico máis ou menos, se a banda cambiou de
+   * harmónico); só usa sin/cos cando non hai paso anterior, o xiro é
+   * grande ou lle toca á banda a quenda exacta. Os seguintes harmónicos
+   * van por rotación.
+   */
+  VOCODER_ALWAYS_INLINE void assignHarmonics(float pitch,
+                                             const float *bandFreqs) {
+    const float w0 = 2.0f * static_cast<float>(M_PI) * pitch / mSampleRate;
+    const float invPitch = 1.0f / pitch;
+    const float deltaW0 = w0 - mLastW0;
+    mLastW0 = w0;
+    const int exactBand = mExactBand;
+    mExactBand = (mExactBand + 1) % NumBands;
+
+    // Paso dun harmónico: exacto coa quenda da banda 0
+    if (mFirst[0] == 0 || exactBand == 0 || std::abs(deltaW0) > kMaxRotation) {
+      mStepCos = std::cos(w0);
+      mStepSin = std::sin(w0);
+    } else {
+      rotate(mStepCos, mStepSin, deltaW0);
+    }
+    const float stepCos = mStepCos;
+    const float stepSin = mStepSin;
+
+    // Primeiro harmónico de cada banda e o seu paso rotado, sen ramas
+    // para que o bucle se vectorice; as bandas que non se poden rotar
+    // quedan marcadas para sin/cos
+    std::array<int, NumBands> exact;
+    for (int band = 0; band < NumBands; band++) {
+      float ratio = bandFreqs[band] * invPitch;
+      int first = std::clamp(static_cast<int>(ratio) -
+                                 (kPartialsPerBand - 1) / 2,
+                             1, kMaxHarmonic - kPartialsPerBand + 1);
+      int shift = first - mFirst[band];
+      float angle = mFirst[band] * deltaW0;
+      exact[band] = mFirst[band] == 0 || shift < -1 || shift > 1 ||
+                    std::abs(angle) > kMaxRotation || band == exactBand;
+      // Xiro polo cambio de w0 e, se cambiou, un harmónico
+      float c = mFirstCos[band];
+      float s = mFirstSin[band];
+      rotate(c, s, angle);
+      float hs = shift * stepSin;
+      float hc = shift != 0 ? stepCos : 1.0f;
+      mFirstCos[band] = c * hc - s * hs;
+      mFirstSin[band] = s * hc + c * hs;
+      mFirst[band] = first;
+      mBandRatio[band] = ratio;
+    }
+    for (int band = 0; band < NumBands; band++) {
+      if (exact[band]) {
+        mFirstCos[band] = std::cos(mFirst[band] * w0);
+        mFirstSin[band] = std::sin(mFirst[band] * w0);
+      }
+    }
+
+    for (int band = 0; band < NumBands; band++) {
+      const int first = mFirst[band];
+      const float ratio = mBandRatio[band];
+      float c = mFirstCos[band];
+      float s = mFirstSin[band];
+      for (int i = 0; i < kPartialsPerBand; i++) {
+        int h = first + i;
+        // Cada slot queda co harmónico de residuo h % kPartialsPerBand:
+        // ao subir o pitch só salta o parcial máis afastado do centro, e
+        // o que se mantén conserva a fase
+        int p = (h % kPartialsPerBand) * NumBands + band;
+        mHarmonic[p] = h;
+        mNewCos[p] = c;
+        mNewSin[p] = s;
+        mInvCentre[p] = mInvBandFreq[band];
+        mRatio[p] = ratio;
+        float next = c * stepCos - s * stepSin;
+        s = s * stepCos + c * stepSin;
+        c = next;
+      }
+    }
+  }
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstring>
+
+/**
+ * Variantes dos kernels DSP segundo o conxunto de instrucións.
+ *
+ * O bucle por bloque do procesador e o que chama por mostra ou por
+ * bloque de control (bancos de filtros, envolventes, osciladores, carrier
+ * aditivo, LPC, lectura do carrier externo e mestura) compílanse unha vez
+ * por variante dentro de funcións con __attribute__((target)), así que a
+ * mesma biblioteca corre en calquera CPU do ABI e aproveita AVX2 onde o
+ * hai. Eses métodos son VOCODER_ALWAYS_INLINE: unha copia fóra de liña
+ * correría na ISA base. Os axustes puntuais (formante, panorama,
+ * reinicios), o detector de pitch, o time-stretch do ficheiro e a
+ * decodificación das mostras int16 (decodeSamples) non teñen variantes.
+ * A variante escóllese ao arrancar o motor (detectKernelVariant) e
+ * pódese forzar para probas.
+ *
+ * As variantes só cambian o ancho dos vectores, non as operacións: en x86
+ * a app compílase sen contraccións a FMA nin sumas reasociadas
+ * (VocoderOptions.cmake) e así a saída de cada unha é idéntica bit a bit
+ * á xenérica. session_replay --check-kernels compílase cos mesmos flags
+ * e compróbao.
+ *
+ * ARM: NEON xa é a base dos ABI arm64-v8a e armeabi-v7a, e as extensións
+ * posteriores (dotprod, FP16) son para int8 e media precisión; os
+ * kernels en float32 non teñen variante propia.
+ */
+enum class KernelVariant : int {
+  Generic = 0, // Base do ABI (SSE4.2 en x86_64, NEON en ARM, SIMD128 en wasm)
+  Avx2,        // x86: AVX2 (sen FMA, que cambiaría o redondeo)
+  Count
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VOCODER_KERNELS_AVX2 1
+#define VOCODER_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define VOCODER_KERNELS_AVX2 0
+#endif
+
+#define VOCODER_ALWAYS_INLINE inline __attribute__((always_inline))
+
+inline const char *kernelVariantName(KernelVariant variant) {
+  switch (variant) {
+  case KernelVariant::Avx2:
+    return "avx2";
+  default:
+    return "generic";
+  }
+}
+
+// -1 se o nome non corresponde a ningunha variante
+inline int kernelVariantFromName(const char *name) {
+  for (int i = 0; i < static_cast<int>(KernelVariant::Count); i++) {
+    if (std::strcmp(name, kernelVariantName(static_cast<KernelVariant>(i))) ==
+        0)
+      return i;
+  }
+  return -1;
+}
+
+inline bool isKernelVariantSupported(KernelVariant variant) {
+  switch (variant) {
+  case KernelVariant::Generic:
+    return true;
+#if VOCODER_KERNELS_AVX2
+  case KernelVariant::Avx2:
+    return __builtin_cpu_supports("avx2");
+#endif
+  default:
+    return false;
+  }
+}
+
+// A mellor variante que admite esta CPU
+inline KernelVariant detectKernelVariant() {
+  for (int i = static_cast<int>(KernelVariant::Count) - 1; i > 0; i--) {
+    auto variant = static_cast<KernelVariant>(i);
+    if (isKernelVariantSupported(variant))
+      return variant;
+  }
+  return KernelVariant::Generic;
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "CpuFeatures.h"
 #include <array>
 #include <cmath>
 #include <vector>
@@ -17,8 +18,9 @@ public:
 
   void setFrequency(float freq) { mFrequency = freq; }
   void setWaveform(Waveform wave) { mWaveform = wave; }
+  void reset() { mPhase = 0.0f; }
 
-  float process() {
+  VOCODER_ALWAYS_INLINE float process() {
     float sample = 0.0f;
     int index = static_cast<int>(mPhase * kTableSize) & (kTableSize - 1);
 
@@ -92,7 +94,7 @@ public:
     a2 /= a0;
   }
 
-  float process(float input) {
+  VOCODER_ALWAYS_INLINE float process(float input) {
     float output = b0 * input + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
     x2 = x1;
     x1 = input;
@@ -101,6 +103,8 @@ public:
     return output;
   }
 
+  void reset() { x1 = x2 = y1 = y2 = 0.0f; }
+
 private:
   float b0 = 0, b1 = 0, b2 = 0;
   float a1 = 0, a2 = 0;
@@ -131,7 +135,48 @@ public:
     a2 /= a0;
   }
 
-  float process(float input) {
+  VOCODER_ALWAYS_INLINE float process(float input) {
+    float output = b0 * input + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+    x2 = x1;
+    x1 = input;
+    y2 = y1;
+    y1 = output;
+    return output;
+  }
+
+  void reset() { x1 = x2 = y1 = y2 = 0.0f; }
+
+private:
+  float b0 = 0, b1 = 0, b2 = 0;
+  float a1 = 0, a2 = 0;
+  float x1 = 0, x2 = 0, y1 = 0, y2 = 0;
+};
+
+/**
+ * Filtro biquad lowpass.
+ */
+class LowPassFilter {
+public:
+  void setCoefficients(float freq, float q, float sampleRate) {
+    float w0 = 2.0f * M_PI * freq / sampleRate;
+    float alpha = std::sin(w0) / (2.0f * q);
+    float cosw0 = std::cos(w0);
+
+    b0 = (1.0f - cosw0) / 2.0f;
+    b1 = 1.0f - cosw0;
+    b2 = (1.0f - cosw0) / 2.0f;
+    float a0 = 1.0f + alpha;
+    a1 = -2.0f * cosw0;
+    a2 = 1.0f - alpha;
+
+    b0 /= a0;
+    b1 /= a0;
+    b2 /= a0;
+    a1 /= a0;
+    a2 /= a0;
+  }
+
+  VOCODER_ALWAYS_INLINE float process(float input) {
     float output = b0 * input + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
     x2 = x1;
     x1 = input;
@@ -140,6 +185,8 @@ public:
     return output;
   }
 
+  void reset() { x1 = x2 = y1 = y2 = 0.0f; }
+
 private:
   float b0 = 0, b1 = 0, b2 = 0;
   float a1 = 0, a2 = 0;
@@ -162,7 +209,7 @@ public:
     mRelease = std::exp(-1.0f / (sampleRate * releaseMs * 0.001f));
   }
 
-  float process(float input) {
+  VOCODER_ALWAYS_INLINE float process(float input) {
     float rectified = std::abs(input);
     if (rectified > mEnvelope) {
       mEnvelope = mAttack * mEnvelope + (1.0f - mAttack) * rectified;
@@ -176,6 +223,11 @@ public:
     return mSmoothEnv;
   }
 
+  void reset() {
+    mEnvelope = 0.0f;
+    mSmoothEnv = 0.0f;
+  }
+
 private:
   float mAttack = 0.0f;
   float mRelease = 0.0f;
@@ -197,7 +249,13 @@ public:
 
   void setTarget(float target) { mTargetValue = target; }
 
-  float process() {
+  // Salta ao valor sen rampa
+  void reset(float value) {
+    mCurrentValue = value;
+    mTargetValue = value;
+  }
+
+  VOCODER_ALWAYS_INLINE float process() {
     mCurrentValue = mAlpha * mCurrentValue + (1.0f - mAlpha) * mTargetValue;
     return mCurrentValue;
   }
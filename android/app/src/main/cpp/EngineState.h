@@ -0,0 +1,162 @@
+#pragma once
+
+#include "ParameterMailbox.h"
+#include "SampleReader.h"
+#include "TimeStretcher.h"
+#include "VocoderProcessor.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+static constexpr size_t kCacheLineSize = 64;
+
+// Capa principal (handle 0) máis as adicionais que se poden crear
+static constexpr int kMaxLayers = 4;
+
+/**
+ * Estado en tempo real do motor, reservado nun único bloque aliñado.
+ *
+ * Os campos agrúpanse segundo o fío que os escribe, e cada grupo empeza
+ * nunha liña de caché propia. Así a UI pode consultar os medidores a 60 Hz
+ * sen invalidar as liñas que o callback escribe en cada bloque, e os
+ * cambios de control da UI non comparten liña co estado de audio.
+ */
+
+// Escribe a UI, le o callback (agás recordingFull)
+struct alignas(kCacheLineSize) EngineControls {
+  std::atomic<int> source{0}; // 0 = Mic, 1 = File
+  std::atomic<int> waveformType{0};
+  std::atomic<bool> isFilePlaying{false};
+  std::atomic<bool> isMicActive{false};
+  std::atomic<bool> isRecording{false};
+  std::atomic<bool> recordingFull{false}; // O callback detivo a gravación
+  std::atomic<bool> fileResetPending{false};
+  std::atomic<float> fileSpeed{1.0f};
+  std::atomic<uint32_t> carrierId{0}; // Cambia con cada carrier cargado
+  std::atomic<int> kernelVariant{0};   // KernelVariant (CpuFeatures.h)
+
+  // Parámetros do procesador: aplícaos o callback ao comezo de cada bloque
+  ParameterMailbox params;
+
+  // Capas adicionais (handle = índice + 1)
+  struct Layer {
+    std::atomic<bool> active{false};
+    std::atomic<uint32_t> generation{0}; // Cambia con cada createLayer
+    ParameterMailbox params;
+  };
+  std::array<Layer, kMaxLayers - 1> layers;
+};
+
+/**
+ * Instantánea dos medidores por banda (seqlock). O callback publica sen
+ * esperar nunca; a UI repite a lectura se coincidiu cunha publicación,
+ * así que sempre obtén as dúas táboas do mesmo bloque.
+ */
+struct BandMeterSnapshot {
+  static constexpr int kNumBands = VocoderProcessor::kNumBands;
+
+  // Fío de audio
+  void publish(const float *envelope, const float *reduction) {
+    uint32_t seq = sequence.load(std::memory_order_relaxed);
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int i = 0; i < kNumBands; i++) {
+      this->envelope[i].store(envelope[i], std::memory_order_relaxed);
+      this->reduction[i].store(reduction[i], std::memory_order_relaxed);
+    }
+    sequence.store(seq + 2, std::memory_order_release);
+  }
+
+  // Fío da UI: false se non conseguiu unha lectura coherente
+  bool read(float *envelope, float *reduction) const {
+    for (int attempt = 0; attempt < 4; attempt++) {
+      uint32_t before = sequence.load(std::memory_order_acquire);
+      if (before & 1)
+        continue;
+      for (int i = 0; i < kNumBands; i++) {
+        envelope[i] = this->envelope[i].load(std::memory_order_relaxed);
+        reduction[i] = this->reduction[i].load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence.load(std::memory_order_relaxed) == before)
+        return true;
+    }
+    return false;
+  }
+
+  std::atomic<uint32_t> sequence{0}; // Impar mentres se escribe
+  std::array<std::atomic<float>, kNumBands> envelope{};
+  std::array<std::atomic<float>, kNumBands> reduction{};
+};
+
+// Escribe o callback, le a UI
+struct alignas(kCacheLineSize) EngineMeters {
+  static constexpr int kWaveformSize = 256;
+
+  std::atomic<float> vuLevel{0.0f};
+  // Seguidor de pitch da principal: f0 (0 = sen voz), confianza, latencia
+  // da estimación e carga. Copias: a UI non le o estado do procesador
+  std::atomic<float> pitchFrequency{0.0f};
+  std::atomic<float> pitchConfidence{0.0f};
+  std::atomic<float> pitchLatencyMs{0.0f};
+  std::atomic<float> pitchLoad{0.0f};
+  std::atomic<float> fileStretchLoad{0.0f}; // Time-stretch do modulador
+  alignas(kCacheLineSize) std::array<float, kWaveformSize> waveform{};
+  alignas(kCacheLineSize) BandMeterSnapshot bands;
+};
+
+// Procesador dunha capa adicional. Resérvanse todas ao crear o motor:
+// crear ou destruír unha capa só cambia EngineControls::Layer::active
+struct alignas(kCacheLineSize) LayerAudioState {
+  explicit LayerAudioState(float sampleRate) : processor(sampleRate) {
+    processor.setSoftClip(false); // Satúrase a mestura (ver renderChunk)
+  }
+
+  VocoderProcessor processor;
+  // Lector propio do carrier externo compartido: cada capa avanza ao seu
+  // pitch sen mover a posición da principal nin das outras
+  SampleReader carrierReader;
+  ParameterMailbox::Versions appliedParams{};
+  uint32_t generation = 0; // A de controls cando se reiniciou o procesador
+  bool active = false;
+  bool extCarrier = false; // Forma de onda 4 (carrier externo)
+};
+
+// Só o callback
+struct alignas(kCacheLineSize) EngineAudioState {
+  // Tamaño máximo dun bloque procesado de vez; callbacks maiores trocéanse
+  static constexpr int kMaxCallbackFrames = 1024;
+
+  static_assert(kMaxLayers == 4, "Update the layers initialiser");
+  explicit EngineAudioState(float sampleRate)
+      : processor(sampleRate), fileStretcher(sampleRate),
+        layers{{LayerAudioState(sampleRate), LayerAudioState(sampleRate),
+                LayerAudioState(sampleRate)}} {}
+
+  alignas(kCacheLineSize) std::array<float, kMaxCallbackFrames> inputBuffer{};
+  alignas(kCacheLineSize) std::array<float, kMaxCallbackFrames> micBuffer{};
+  alignas(kCacheLineSize) VocoderProcessor processor;
+  alignas(kCacheLineSize) TimeStretcher fileStretcher;
+  alignas(kCacheLineSize) SampleReader carrierReader;
+
+  ParameterMailbox::Versions appliedParams{};
+  uint32_t captureSession = 0;
+  uint64_t captureFrame = 0;
+  uint32_t carrierId = 0; // O do carrier que está a ler carrierReader
+  int kernelVariant = 0; // Aplicada aos procesadores
+
+  // Capas: procésanse por bloques de kMaxBlockFrames tras a principal,
+  // reutilizando as súas envolventes, e súmanse á saída
+  std::array<LayerAudioState, kMaxLayers - 1> layers;
+  static constexpr int kLayerOutputSize =
+      VocoderProcessor::kMaxBlockFrames * VocoderProcessor::kOutputChannels;
+  alignas(kCacheLineSize) std::array<float, kLayerOutputSize> layerOutput{};
+};
+
+struct EngineState {
+  explicit EngineState(float sampleRate) : audio(sampleRate) {}
+
+  EngineControls controls;
+  EngineMeters meters;
+  EngineAudioState audio;
+};
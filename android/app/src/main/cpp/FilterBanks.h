@@ -0,0 +1,179 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include <array>
+#include <cmath>
+
+/**
+ * Bancos de filtros pasa-banda para o vocoder.
+ *
+ * Cada banco garda o estado de todas as bandas en formato SoA e procesa
+ * unha mostra de entrada en todas elas á vez: o bucle sobre as bandas non
+ * ten dependencias entre iteracións e o compilador vectorízao. Todos teñen
+ * ganancia 0 dB no pico, como o BandpassFilter RBJ orixinal.
+ *
+ * Interface común (política de VocoderProcessorT):
+ *   void setBand(int band, float freq, float q, float sampleRate);
+ *   void process(float input, float *output);  // output[kSize]
+ *   void reset();                              // Estado a cero
+ */
+
+/**
+ * Biquad RBJ en forma directa I (a topoloxía orixinal).
+ */
+template <int N> class RbjBandpassBank {
+public:
+  static constexpr int kSize = N;
+  static constexpr const char *kName = "RBJ biquad (DF-I)";
+
+  void setBand(int band, float freq, float q, float sampleRate) {
+    float w0 = 2.0f * M_PI * freq / sampleRate;
+    float alpha = std::sin(w0) / (2.0f * q);
+    float a0 = 1.0f + alpha;
+    b0[band] = alpha / a0;
+    a1[band] = -2.0f * std::cos(w0) / a0;
+    a2[band] = (1.0f - alpha) / a0;
+  }
+
+  VOCODER_ALWAYS_INLINE void process(float input, float *output) {
+    for (int i = 0; i < N; i++) {
+      // b1 = 0, b2 = -b0
+      float y = b0[i] * (input - x2[i]) - a1[i] * y1[i] - a2[i] * y2[i];
+      x2[i] = x1[i];
+      x1[i] = input;
+      y2[i] = y1[i];
+      y1[i] = y;
+      output[i] = y;
+    }
+  }
+
+  void reset() {
+    x1.fill(0.0f);
+    x2.fill(0.0f);
+    y1.fill(0.0f);
+    y2.fill(0.0f);
+  }
+
+private:
+  std::array<float, N> b0{}, a1{}, a2{};
+  std::array<float, N> x1{}, x2{}, y1{}, y2{};
+};
+
+/**
+ * Biquad en forma directa II transposta: dous estados por banda.
+ */
+template <int N> class TdfIIBandpassBank {
+public:
+  static constexpr int kSize = N;
+  static constexpr const char *kName = "Biquad (DF-II transposed)";
+
+  void setBand(int band, float freq, float q, float sampleRate) {
+    float w0 = 2.0f * M_PI * freq / sampleRate;
+    float alpha = std::sin(w0) / (2.0f * q);
+    float a0 = 1.0f + alpha;
+    b0[band] = alpha / a0;
+    a1[band] = -2.0f * std::cos(w0) / a0;
+    a2[band] = (1.0f - alpha) / a0;
+  }
+
+  VOCODER_ALWAYS_INLINE void process(float input, float *output) {
+    for (int i = 0; i < N; i++) {
+      float y = b0[i] * input + s1[i];
+      s1[i] = s2[i] - a1[i] * y;
+      s2[i] = -b0[i] * input - a2[i] * y;
+      output[i] = y;
+    }
+  }
+
+  // Variante cunha entrada distinta por banda (para encadear bancos)
+  VOCODER_ALWAYS_INLINE void process(const float *input, float *output) {
+    for (int i = 0; i < N; i++) {
+      float y = b0[i] * input[i] + s1[i];
+      s1[i] = s2[i] - a1[i] * y;
+      s2[i] = -b0[i] * input[i] - a2[i] * y;
+      output[i] = y;
+    }
+  }
+
+  void reset() {
+    s1.fill(0.0f);
+    s2.fill(0.0f);
+  }
+
+private:
+  std::array<float, N> b0{}, a1{}, a2{};
+  std::array<float, N> s1{}, s2{};
+};
+
+/**
+ * Filtro de estado variable TPT (trapezoidal). Estable con modulación
+ * rápida de frecuencia e barato de recalcular (unha tan por banda), polo
+ * que admite mover as bandas cada bloque.
+ */
+template <int N> class SvfBandpassBank {
+public:
+  static constexpr int kSize = N;
+  static constexpr const char *kName = "TPT state-variable";
+
+  void setBand(int band, float freq, float q, float sampleRate) {
+    float g = std::tan(static_cast<float>(M_PI) * freq / sampleRate);
+    float k = 1.0f / q;
+    mA1[band] = 1.0f / (1.0f + g * (g + k));
+    mA2[band] = g * mA1[band];
+    mK[band] = k;
+  }
+
+  VOCODER_ALWAYS_INLINE void process(float input, float *output) {
+    for (int i = 0; i < N; i++) {
+      float v3 = input - ic2[i];
+      float v1 = mA1[i] * ic1[i] + mA2[i] * v3;
+      float v2 = ic2[i] + mA2[i] * v1;
+      ic1[i] = 2.0f * v1 - ic1[i];
+      ic2[i] = 2.0f * v2 - ic2[i];
+      // k * band = pasa-banda con 0 dB no pico
+      output[i] = mK[i] * v1;
+    }
+  }
+
+  void reset() {
+    ic1.fill(0.0f);
+    ic2.fill(0.0f);
+  }
+
+private:
+  std::array<float, N> mA1{}, mA2{}, mK{};
+  std::array<float, N> ic1{}, ic2{};
+};
+
+/**
+ * Pasa-banda de 4ª orde: dous biquads DF-II transpostos en serie por
+ * banda. O Q de cada etapa redúcese para manter o ancho a -3 dB do
+ * biquad simple, pero coas caídas ao dobre de pendente.
+ */
+template <int N> class CascadedBandpassBank {
+public:
+  static constexpr int kSize = N;
+  static constexpr const char *kName = "Cascaded 4th-order";
+
+  void setBand(int band, float freq, float q, float sampleRate) {
+    // sqrt(sqrt(2) - 1): estreitamento de dúas etapas idénticas
+    constexpr float kStageQScale = 0.6436f;
+    mStage1.setBand(band, freq, q * kStageQScale, sampleRate);
+    mStage2.setBand(band, freq, q * kStageQScale, sampleRate);
+  }
+
+  VOCODER_ALWAYS_INLINE void process(float input, float *output) {
+    mStage1.process(input, mTemp.data());
+    mStage2.process(mTemp.data(), output);
+  }
+
+  void reset() {
+    mStage1.reset();
+    mStage2.reset();
+  }
+
+private:
+  TdfIIBandpassBank<N> mStage1;
+  TdfIIBandpassBank<N> mStage2;
+  std::array<float, N> mTemp{};
+};
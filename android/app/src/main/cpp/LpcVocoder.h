@@ -0,0 +1,177 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+/**
+ * Vocoder por predición lineal (LPC): alternativa ao banco de filtros
+ * cun custo por mostra baixo e fixo.
+ *
+ * Cada kHop mostras analízase unha xanela Hann de kWindow mostras do
+ * modulador (con pre-énfase): autocorrelación e Levinson-Durbin dan os
+ * coeficientes de reflexión e o erro de predición. O carrier pasa por un
+ * filtro todo-polos en celosía con eses coeficientes, que se interpolan
+ * mostra a mostra entre análises; en celosía a interpolación segue sendo
+ * estable mentres |k| < 1, o que Levinson garante. A saída pasa por un
+ * de-énfase que compensa o pre-énfase da análise.
+ *
+ * Custo: (kOrder + 1) produtos escalares de kWindow por salto (~70
+ * MAC/mostra) máis 2 * kOrder MAC/mostra na síntese, fronte ás 40
+ * biquads e 20 seguidores de envolvente do banco de filtros.
+ */
+class LpcVocoder {
+public:
+  static constexpr int kOrder = 16;
+  static constexpr int kWindow = 512;
+  static constexpr int kHop = 128;
+
+  LpcVocoder(float sampleRate) {
+    mWindowEnergy = 0.0f;
+    for (int i = 0; i < kWindow; i++) {
+      mWindow[i] = 0.5f - 0.5f * std::cos(2.0f * M_PI * (i + 0.5f) / kWindow);
+      mWindowEnergy += mWindow[i] * mWindow[i];
+    }
+    // Xanela de lag gaussiana (60 Hz): suaviza picos estreitos
+    for (int i = 0; i <= kOrder; i++) {
+      float x = 2.0f * M_PI * 60.0f * i / sampleRate;
+      mLagWindow[i] = std::exp(-0.5f * x * x);
+    }
+    reset();
+  }
+
+  void reset() {
+    mHistory.fill(0.0f);
+    mState.fill(0.0f);
+    mK.fill(0.0f);
+    mKStep.fill(0.0f);
+    mWritePos = 0;
+    mHopCount = 0;
+    mPrevInput = 0.0f;
+    mPrevOutput = 0.0f;
+    mGain = 0.0f;
+    mGainStep = 0.0f;
+  }
+
+  /**
+   * Unha mostra: modulator é a entrada de análise (xa preamplificada),
+   * excitation o carrier. threshold é o limiar da porta de ruído.
+   */
+  VOCODER_ALWAYS_INLINE float process(float modulator, float excitation,
+                                      float threshold) {
+    float emphasised = modulator - kPreEmphasis * mPrevInput;
+    mPrevInput = modulator;
+    mHistory[mWritePos] = emphasised;
+    mWritePos = (mWritePos + 1) & (kWindow - 1);
+    if (++mHopCount == kHop) {
+      mHopCount = 0;
+      analyse(threshold);
+    }
+
+    for (int i = 0; i < kOrder; i++)
+      mK[i] += mKStep[i];
+    mGain += mGainStep;
+
+    // Síntese en celosía, etapa i (1..kOrder, k_i = mK[i - 1]):
+    //   f_{i-1}[n] = f_i[n] - k_i b_{i-1}[n-1]
+    //   b_i[n] = b_{i-1}[n-1] + k_i f_{i-1}[n]
+    float f = excitation * mGain;
+    f -= mK[kOrder - 1] * mState[kOrder - 1];
+    for (int i = kOrder - 1; i > 0; i--) {
+      f -= mK[i - 1] * mState[i - 1];
+      mState[i] = mState[i - 1] + mK[i - 1] * f;
+    }
+    mState[0] = f;
+
+    // De-énfase 1 / (1 - kPreEmphasis z^-1): o filtro modela o espectro
+    // co pre-énfase, así que a saída recupera aquí a inclinación orixinal
+    mPrevOutput = f + kPreEmphasis * mPrevOutput;
+    return mPrevOutput;
+  }
+
+private:
+  static constexpr float kPreEmphasis = 0.9f;
+  static constexpr float kHysteresis = 0.4f; // Como a porta do banco
+
+  std::array<float, kWindow> mWindow{};
+  std::array<float, kOrder + 1> mLagWindow{};
+  float mWindowEnergy = 1.0f;
+
+  std::array<float, kWindow> mHistory{};
+  std::array<float, kWindow> mFrame{};
+  int mWritePos = 0;
+  int mHopCount = 0;
+  float mPrevInput = 0.0f;
+  float mPrevOutput = 0.0f; // De-énfase
+
+  // Coeficientes de reflexión actuais e incremento por mostra
+  std::array<float, kOrder> mK{};
+  std::array<float, kOrder> mKStep{};
+  float mGain = 0.0f;
+  float mGainStep = 0.0f;
+
+  // Estado da celosía: mState[i] = b_i[n-1]
+  std::array<float, kOrder> mState{};
+
+  static float dot(const float *a, const float *b, int n) {
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+      s0 += a[i] * b[i];
+      s1 += a[i + 1] * b[i + 1];
+      s2 += a[i + 2] * b[i + 2];
+      s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; i++)
+      s0 += a[i] * b[i];
+    return (s0 + s1) + (s2 + s3);
+  }
+
+  VOCODER_ALWAYS_INLINE void analyse(float threshold) {
+    // A historia circular empeza en mWritePos (a mostra máis antiga)
+    for (int i = 0; i < kWindow; i++)
+      mFrame[i] = mHistory[(mWritePos + i) & (kWindow - 1)] * mWindow[i];
+
+    std::array<float, kOrder + 1> r;
+    for (int lag = 0; lag <= kOrder; lag++)
+      r[lag] = dot(mFrame.data(), mFrame.data() + lag, kWindow - lag) *
+               mLagWindow[lag];
+
+    float level = std::sqrt(r[0] / mWindowEnergy);
+    std::array<float, kOrder> target{};
+    float targetGain = 0.0f;
+
+    if (level > threshold) {
+      // Corrección de ruído branco (-40 dB) para un sistema ben condicionado
+      r[0] *= 1.0001f;
+
+      // Levinson-Durbin: A(z) = 1 + sum a_i z^-i, target = k_i
+      std::array<float, kOrder + 1> a{};
+      std::array<float, kOrder + 1> prev{};
+      a[0] = 1.0f;
+      float error = r[0];
+      for (int i = 1; i <= kOrder; i++) {
+        float acc = r[i];
+        for (int j = 1; j < i; j++)
+          acc += a[j] * r[i - j];
+        float k = std::clamp(-acc / error, -0.999f, 0.999f);
+        prev = a;
+        for (int j = 1; j < i; j++)
+          a[j] = prev[j] + k * prev[i - j];
+        a[i] = k;
+        target[i - 1] = k;
+        error *= 1.0f - k * k;
+      }
+
+      // Ganancia: potencia do residuo, coa mesma porta con histéresis
+      float residual = std::sqrt(std::max(error, 0.0f) / mWindowEnergy);
+      targetGain = residual * (level - threshold * kHysteresis) / level;
+    }
+
+    constexpr float kInvHop = 1.0f / kHop;
+    for (int i = 0; i < kOrder; i++)
+      mKStep[i] = (target[i] - mK[i]) * kInvHop;
+    mGainStep = (targetGain - mGain) * kInvHop;
+  }
+};
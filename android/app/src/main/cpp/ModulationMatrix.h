@@ -0,0 +1,206 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+/**
+ * Matriz de modulación avaliada a taxa de control.
+ *
+ * As fontes (LFOs, seguidor de envolvente e nivel do modulador) calcúlanse
+ * unha vez cada kControlBlock mostras e a suma de cada destino interpólase
+ * linealmente ao longo do bloque. O custo é fixo por bloque de control,
+ * independentemente do número de slots activos.
+ */
+class ModulationMatrix {
+public:
+  enum class Source { Lfo1 = 0, Lfo2, Lfo3, Envelope, ModLevel, Count };
+  enum class Destination { Pitch = 0, Intensity, Echo, Threshold, Formant, Count };
+
+  static constexpr int kNumSlots = 8;
+  static constexpr int kNumLfos = 3;
+  static constexpr int kControlBlock = 32;
+  static constexpr int kMaxBlockFrames = 256;
+  static constexpr int kNumSources = static_cast<int>(Source::Count);
+  static constexpr int kNumDestinations = static_cast<int>(Destination::Count);
+
+  ModulationMatrix(float sampleRate) : mSampleRate(sampleRate) {
+    float controlRate = sampleRate / kControlBlock;
+    mEnvAttack = std::exp(-1.0f / (controlRate * 0.010f));   // 10ms
+    mEnvRelease = std::exp(-1.0f / (controlRate * 0.150f));  // 150ms
+    reset();
+  }
+
+  // Sen slots, LFOs por defecto en fase cero e rampas a cero
+  void reset() {
+    mSlots.fill(Slot{});
+    mLfos.fill(ControlLfo{});
+    // LFOs por defecto: lento, medio e rápido (seno)
+    setLfo(0, 0.25f, 3);
+    setLfo(1, 1.0f, 3);
+    setLfo(2, 4.0f, 3);
+    mSources.fill(0.0f);
+    mEnvelope = 0.0f;
+    mCurrent.fill(0.0f);
+    mBlockStart.fill(0.0f);
+  }
+
+  // depth en [-1, 1]; 0 desactiva o slot
+  void setSlot(int slot, int source, int destination, float depth) {
+    if (slot < 0 || slot >= kNumSlots || source < 0 ||
+        source >= kNumSources || destination < 0 ||
+        destination >= kNumDestinations)
+      return;
+    mSlots[slot] = {source, destination, std::clamp(depth, -1.0f, 1.0f)};
+  }
+
+  // shape: 0 = Saw, 1 = Square, 2 = Triangle, 3 = Sine (como Oscillator)
+  void setLfo(int index, float rateHz, int shape) {
+    if (index < 0 || index >= kNumLfos)
+      return;
+    mLfos[index].increment =
+        std::clamp(rateHz, 0.01f, 20.0f) * kControlBlock / mSampleRate;
+    mLfos[index].shape = std::clamp(shape, 0, 3);
+  }
+
+  // Activa mentres haxa slots ou algunha rampa non volvese a cero
+  bool isActive() const {
+    for (const auto &slot : mSlots) {
+      if (slot.depth != 0.0f)
+        return true;
+    }
+    for (float value : mCurrent) {
+      if (value != 0.0f)
+        return true;
+    }
+    return false;
+  }
+
+  /**
+   * Avalía a matriz para un bloque (ata kMaxBlockFrames) e xera as
+   * rampas por frame de cada destino, en unidades normalizadas [-1, 1].
+   */
+  VOCODER_ALWAYS_INLINE void process(const float *input, int numFrames) {
+    mBlockStart = mCurrent;
+    int control = 0;
+    for (int start = 0; start < numFrames; start += kControlBlock, control++) {
+      int n = std::min(kControlBlock, numFrames - start);
+      updateSources(input + start, n);
+
+      std::array<float, kNumDestinations> target{};
+      for (const auto &slot : mSlots) {
+        if (slot.depth != 0.0f)
+          target[slot.destination] += slot.depth * mSources[slot.source];
+      }
+
+      float invN = 1.0f / n;
+      for (int d = 0; d < kNumDestinations; d++) {
+        float from = mCurrent[d];
+        float to = std::clamp(target[d], -1.0f, 1.0f);
+        float step = (to - from) * invN;
+        float *ramp = mRamps[d].data() + start;
+        for (int i = 0; i < n; i++)
+          ramp[i] = from + step * (i + 1);
+        mCurrent[d] = to;
+        mControlValues[d][control] = to;
+      }
+    }
+  }
+
+  const float *getRamp(Destination d) const {
+    return mRamps[static_cast<int>(d)].data();
+  }
+
+  /**
+   * Multiplicador 2^(rampa * octaves) por frame do último bloque. exp2
+   * só se avalía nos extremos de cada bloque de control; entre eles o
+   * multiplicador interpólase linealmente.
+   */
+  VOCODER_ALWAYS_INLINE void getScaleRamp(Destination d, float octaves,
+                                          float *scale, int numFrames) const {
+    const int index = static_cast<int>(d);
+    float from = std::exp2(mBlockStart[index] * octaves);
+    int control = 0;
+    for (int start = 0; start < numFrames; start += kControlBlock, control++) {
+      int n = std::min(kControlBlock, numFrames - start);
+      float to = std::exp2(mControlValues[index][control] * octaves);
+      float step = (to - from) / n;
+      for (int i = 0; i < n; i++)
+        scale[start + i] = from + step * (i + 1);
+      from = to;
+    }
+  }
+
+  // Valor ao final do bloque de control n-ésimo (para destinos por bloque)
+  float getControlValue(Destination d, int control) const {
+    return mControlValues[static_cast<int>(d)][control];
+  }
+
+private:
+  struct Slot {
+    int source = 0;
+    int destination = 0;
+    float depth = 0.0f;
+  };
+
+  struct ControlLfo {
+    float phase = 0.0f;
+    float increment = 0.0f;
+    int shape = 3;
+
+    VOCODER_ALWAYS_INLINE float tick() {
+      float value;
+      switch (shape) {
+      case 0:
+        value = 2.0f * phase - 1.0f;
+        break;
+      case 1:
+        value = phase < 0.5f ? 1.0f : -1.0f;
+        break;
+      case 2:
+        value = 4.0f * std::abs(phase - 0.5f) - 1.0f;
+        break;
+      default:
+        value = std::sin(2.0f * static_cast<float>(M_PI) * phase);
+        break;
+      }
+      phase += increment;
+      if (phase >= 1.0f)
+        phase -= 1.0f;
+      return value;
+    }
+  };
+
+  float mSampleRate;
+  std::array<Slot, kNumSlots> mSlots{};
+  std::array<ControlLfo, kNumLfos> mLfos{};
+  std::array<float, kNumSources> mSources{};
+  float mEnvAttack = 0.0f;
+  float mEnvRelease = 0.0f;
+  float mEnvelope = 0.0f;
+
+  std::array<float, kNumDestinations> mCurrent{};
+  std::array<float, kNumDestinations> mBlockStart{}; // mCurrent ao comezo
+  std::array<std::array<float, kMaxBlockFrames>, kNumDestinations> mRamps{};
+  std::array<std::array<float, kMaxBlockFrames / kControlBlock>,
+             kNumDestinations>
+      mControlValues{};
+
+  VOCODER_ALWAYS_INLINE void updateSources(const float *input, int n) {
+    for (int i = 0; i < kNumLfos; i++)
+      mSources[static_cast<int>(Source::Lfo1) + i] = mLfos[i].tick();
+
+    float sumSq = 0.0f;
+    for (int i = 0; i < n; i++)
+      sumSq += input[i] * input[i];
+    // Mesma escala que o preamp do procesador (x10)
+    float level = std::min(1.0f, std::sqrt(sumSq / n) * 10.0f);
+
+    float coeff = level > mEnvelope ? mEnvAttack : mEnvRelease;
+    mEnvelope = coeff * mEnvelope + (1.0f - coeff) * level;
+
+    mSources[static_cast<int>(Source::Envelope)] = mEnvelope;
+    mSources[static_cast<int>(Source::ModLevel)] = level;
+  }
+};
@@ -0,0 +1,213 @@
+#pragma once
+
+#include "ModulationMatrix.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Cambios de parámetro do procesador, codificados en 8 bytes.
+ *
+ * O mesmo formato úsase para pasalos da UI ao callback e para gardalos nas
+ * sesións capturadas (SessionFormat.h), de xeito que o replay aplica
+ * exactamente o mesmo que aplicou o dispositivo. Os valores de ParamId
+ * tamén os usa VocoderBridge.LayerParam: os novos van sempre ao final.
+ */
+enum class ParamId : uint8_t {
+  Pitch = 0,
+  Intensity,
+  Waveform,       // a = tipo (0-3; 4 = carrier externo, ver VocoderEngine)
+  Vibrato,
+  Echo,
+  Tremolo,
+  NoiseThreshold,
+  Formant,
+  Stereo,         // a = 0/1
+  StereoWidth,
+  ModSlot,        // index = slot, a = fonte, b = destino, value = depth
+  ModLfo,         // index = LFO, a = forma, value = Hz
+  PitchFollow,    // a = 0/1
+  PitchInterval,
+  PitchScale,     // a = escala
+  Engine,         // a = 0 banco de filtros, 1 LPC
+  Additive,       // a = 0/1
+  AdditiveTilt,
+  Count
+};
+
+struct ParamChange {
+  ParamId id;
+  uint8_t index;
+  int8_t a;
+  int8_t b;
+  float value;
+};
+static_assert(sizeof(ParamChange) == 8, "ParamChange must pack into 64 bits");
+static_assert(static_cast<int>(ParamId::AdditiveTilt) == 17,
+              "ParamId values are stored in sessions and used from Kotlin");
+
+/**
+ * Aplica un cambio a calquera VocoderProcessorT (motor e ferramenta de
+ * replay comparten esta función).
+ */
+template <typename Processor>
+void applyParamChange(Processor &processor, const ParamChange &change) {
+  switch (change.id) {
+  case ParamId::Pitch:
+    processor.setPitch(change.value);
+    break;
+  case ParamId::Intensity:
+    processor.setIntensity(change.value);
+    break;
+  case ParamId::Waveform:
+    processor.setWaveform(change.a);
+    break;
+  case ParamId::Vibrato:
+    processor.setVibrato(change.value);
+    break;
+  case ParamId::Echo:
+    processor.setEcho(change.value);
+    break;
+  case ParamId::Tremolo:
+    processor.setTremolo(change.value);
+    break;
+  case ParamId::NoiseThreshold:
+    processor.setNoiseThreshold(change.value);
+    break;
+  case ParamId::Formant:
+    processor.setFormant(change.value);
+    break;
+  case ParamId::Stereo:
+    processor.setStereo(change.a != 0);
+    break;
+  case ParamId::StereoWidth:
+    processor.setStereoWidth(change.value);
+    break;
+  case ParamId::ModSlot:
+    processor.setModSlot(change.index, change.a, change.b, change.value);
+    break;
+  case ParamId::ModLfo:
+    processor.setModLfo(change.index, change.value, change.a);
+    break;
+  case ParamId::PitchFollow:
+    processor.setPitchFollow(change.a != 0);
+    break;
+  case ParamId::PitchInterval:
+    processor.setPitchInterval(change.value);
+    break;
+  case ParamId::PitchScale:
+    processor.setPitchScale(change.a);
+    break;
+  case ParamId::Engine:
+    processor.setEngine(change.a);
+    break;
+  case ParamId::Additive:
+    processor.setAdditive(change.a != 0);
+    break;
+  case ParamId::AdditiveTilt:
+    processor.setAdditiveTilt(change.value);
+    break;
+  default:
+    break;
+  }
+}
+
+// Comprobar antes de construír un ParamChange desde enteiros: index, a e b
+// son de 8 bits e un valor fóra de rango acabaría noutro slot ou LFO
+inline bool isValidParamChange(ParamId id, int index, int a, int b) {
+  if (a < INT8_MIN || a > INT8_MAX || b < INT8_MIN || b > INT8_MAX)
+    return false;
+  switch (id) {
+  case ParamId::ModSlot:
+    return index >= 0 && index < ModulationMatrix::kNumSlots;
+  case ParamId::ModLfo:
+    return index >= 0 && index < ModulationMatrix::kNumLfos;
+  default:
+    return index >= 0 && index <= UINT8_MAX; // Sen uso
+  }
+}
+
+/**
+ * Último valor de cada parámetro, escrito pola UI e recollido polo
+ * callback ao comezo de cada bloque (sen locks nin colas que se poidan
+ * encher: os cambios rápidos dun mesmo parámetro colapsan no último).
+ *
+ * Cada slot garda o cambio empaquetado nun atómico de 64 bits e un
+ * contador de versión. O lector aplica os slots cuxa versión cambiou; se
+ * le un valor máis novo que a versión, volve aplicalo no bloque seguinte,
+ * o que é inocuo porque os setters son idempotentes.
+ */
+class ParameterMailbox {
+public:
+  static constexpr int kMaxModSlots = ModulationMatrix::kNumSlots;
+  static constexpr int kMaxLfos = ModulationMatrix::kNumLfos;
+  static constexpr int kNumSlots =
+      static_cast<int>(ParamId::Count) + kMaxModSlots + kMaxLfos - 2;
+
+  using Versions = std::array<uint32_t, kNumSlots>;
+
+  void post(const ParamChange &change) {
+    int slot = slotFor(change);
+    if (slot < 0)
+      return;
+    uint64_t packed;
+    std::memcpy(&packed, &change, sizeof(packed));
+    mSlots[slot].value.store(packed, std::memory_order_release);
+    mSlots[slot].version.fetch_add(1, std::memory_order_release);
+  }
+
+  // Chama fn(change) para cada slot con versión distinta da aplicada
+  template <typename Fn> void collect(Versions &applied, Fn &&fn) const {
+    for (int i = 0; i < kNumSlots; i++) {
+      uint32_t version = mSlots[i].version.load(std::memory_order_acquire);
+      if (version == applied[i])
+        continue;
+      applied[i] = version;
+      fn(load(i));
+    }
+  }
+
+  // Chama fn(change) co valor actual de cada slot escrito algunha vez
+  template <typename Fn> void forEachSet(Fn &&fn) const {
+    for (int i = 0; i < kNumSlots; i++) {
+      if (mSlots[i].version.load(std::memory_order_acquire) != 0)
+        fn(load(i));
+    }
+  }
+
+private:
+  struct Slot {
+    std::atomic<uint64_t> value{0};
+    std::atomic<uint32_t> version{0};
+  };
+  std::array<Slot, kNumSlots> mSlots{};
+
+  // ModSlot e ModLfo ocupan un slot por índice, ao final da táboa
+  static int slotFor(const ParamChange &change) {
+    constexpr int kModSlotBase = static_cast<int>(ParamId::Count);
+    constexpr int kLfoBase = kModSlotBase + kMaxModSlots - 1;
+    int id = static_cast<int>(change.id);
+    if (id >= static_cast<int>(ParamId::Count))
+      return -1;
+    if (change.id == ParamId::ModSlot) {
+      if (change.index == 0)
+        return id;
+      return change.index < kMaxModSlots ? kModSlotBase + change.index - 1
+                                         : -1;
+    }
+    if (change.id == ParamId::ModLfo) {
+      if (change.index == 0)
+        return id;
+      return change.index < kMaxLfos ? kLfoBase + change.index - 1 : -1;
+    }
+    return id;
+  }
+
+  ParamChange load(int slot) const {
+    uint64_t packed = mSlots[slot].value.load(std::memory_order_acquire);
+    ParamChange change;
+    std::memcpy(&change, &packed, sizeof(change));
+    return change;
+  }
+};
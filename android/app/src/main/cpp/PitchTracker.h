@@ -0,0 +1,198 @@
+#pragma once
+
+#include "DSPComponents.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+/**
+ * Detector de pitch YIN incremental para seguir a voz do modulador.
+ *
+ * Traballa sobre a entrada diezmada x4 (12 kHz a 48 kHz) e analiza unha
+ * vez por cada salto de kHop mostras diezmadas (~1 callback de 256 frames;
+ * os callbacks máis longos fan unha análise por salto completo), de xeito
+ * que o custo por mostra é constante. A función diferenza
+ * exprésase como enerxías (sumas prefixas) menos a autocorrelación cruzada,
+ * cuxo bucle interno é un produto escalar contiguo que o compilador
+ * vectoriza.
+ */
+class PitchTracker {
+public:
+  static constexpr int kDecimation = 4;
+  static constexpr int kWindow = 256;   // Mostras diezmadas por análise
+  static constexpr int kHop = 64;       // Salto entre análises
+  static constexpr int kMaxLagCap = 256;
+  static constexpr float kMinF0 = 60.0f;
+  static constexpr float kMaxF0 = 800.0f;
+  static constexpr float kYinThreshold = 0.15f;
+  static constexpr float kSilenceRms = 0.002f;
+
+  PitchTracker(float sampleRate) { setSampleRate(sampleRate); }
+
+  void setSampleRate(float sampleRate) {
+    mSampleRate = sampleRate;
+    mRate = sampleRate / kDecimation;
+    mMinLag = std::max(2, static_cast<int>(mRate / kMaxF0));
+    mMaxLag = std::min(kMaxLagCap, static_cast<int>(std::ceil(mRate / kMinF0)));
+    // Anti-alias para o diezmado: dous biquads en cascada
+    float cutoff = mRate * 0.4f;
+    mAntiAlias1.setCoefficients(cutoff, 0.54f, sampleRate);
+    mAntiAlias2.setCoefficients(cutoff, 1.31f, sampleRate);
+    reset();
+  }
+
+  void reset() {
+    mAntiAlias1.reset();
+    mAntiAlias2.reset();
+    mBuffer.fill(0.0f);
+    mPhase = 0;
+    mPending = 0;
+    mFrequency = 0.0f;
+    mConfidence = 0.0f;
+  }
+
+  /**
+   * Alimenta un bloque da entrada a taxa completa.
+   * Devolve true se se actualizou a estimación de f0 neste bloque.
+   */
+  bool process(const float *input, int numFrames) {
+    bool updated = false;
+    for (int i = 0; i < numFrames; i++) {
+      float filtered = mAntiAlias2.process(mAntiAlias1.process(input[i]));
+      if (++mPhase < kDecimation)
+        continue;
+      mPhase = 0;
+      // As mostras novas agárdanse ata completar un salto
+      mIncoming[mPending++] = filtered;
+      if (mPending == kHop) {
+        advance();
+        updated = true;
+      }
+    }
+    return updated;
+  }
+
+  // Frecuencia fundamental detectada (0 se non hai voz)
+  float getFrequency() const { return mFrequency; }
+  float getConfidence() const { return mConfidence; }
+
+  // Latencia aproximada da estimación: metade da xanela analizada + salto
+  float getLatencyMs() const {
+    return ((kWindow + mMaxLag) * 0.5f + kHop) * 1000.0f / mRate;
+  }
+
+  // Custo medio dunha análise, en ns e en % do tempo real dun salto
+  float getAnalysisNs() const { return mAnalysisNs; }
+  float getCpuLoad() const {
+    float hopNs = kHop * kDecimation * 1.0e9f / mSampleRate;
+    return mAnalysisNs / hopNs;
+  }
+
+private:
+  float mSampleRate = 48000.0f;
+  float mRate = 12000.0f;
+  int mMinLag = 15;
+  int mMaxLag = 200;
+
+  LowPassFilter mAntiAlias1;
+  LowPassFilter mAntiAlias2;
+  int mPhase = 0;
+  int mPending = 0;
+
+  std::array<float, kWindow + kMaxLagCap> mBuffer{};
+  std::array<float, kHop> mIncoming{};
+  std::array<float, kWindow + kMaxLagCap + 1> mPrefixEnergy{};
+  std::array<float, kMaxLagCap + 1> mDiff{};
+
+  float mFrequency = 0.0f;
+  float mConfidence = 0.0f;
+  float mAnalysisNs = 0.0f;
+
+  static float dot(const float *a, const float *b, int n) {
+    // Catro acumuladores independentes para facilitar a vectorización
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+      s0 += a[i] * b[i];
+      s1 += a[i + 1] * b[i + 1];
+      s2 += a[i + 2] * b[i + 2];
+      s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; i++)
+      s0 += a[i] * b[i];
+    return (s0 + s1) + (s2 + s3);
+  }
+
+  // Despraza a xanela un salto coas mostras agardadas e analiza
+  void advance() {
+    const int bufferSize = kWindow + mMaxLag;
+    auto t0 = std::chrono::steady_clock::now();
+
+    std::memmove(mBuffer.data(), mBuffer.data() + kHop,
+                 (bufferSize - kHop) * sizeof(float));
+    std::memcpy(mBuffer.data() + bufferSize - kHop, mIncoming.data(),
+                kHop * sizeof(float));
+    mPending = 0;
+    analyse();
+
+    auto t1 = std::chrono::steady_clock::now();
+    float ns = std::chrono::duration<float, std::nano>(t1 - t0).count();
+    mAnalysisNs = 0.95f * mAnalysisNs + 0.05f * ns;
+  }
+
+  void analyse() {
+    const float *x = mBuffer.data();
+    const int bufferSize = kWindow + mMaxLag;
+
+    mPrefixEnergy[0] = 0.0f;
+    for (int i = 0; i < bufferSize; i++)
+      mPrefixEnergy[i + 1] = mPrefixEnergy[i] + x[i] * x[i];
+
+    float e0 = mPrefixEnergy[kWindow];
+    if (e0 < kSilenceRms * kSilenceRms * kWindow) {
+      mConfidence = 0.0f;
+      mFrequency = 0.0f;
+      return;
+    }
+
+    // Función diferenza acumulada normalizada (CMNDF)
+    mDiff[0] = 1.0f;
+    float runningSum = 0.0f;
+    int bestLag = -1;
+    for (int tau = 1; tau <= mMaxLag; tau++) {
+      float eTau = mPrefixEnergy[tau + kWindow] - mPrefixEnergy[tau];
+      float d = e0 + eTau - 2.0f * dot(x, x + tau, kWindow);
+      runningSum += d;
+      mDiff[tau] = runningSum > 0.0f ? d * tau / runningSum : 1.0f;
+
+      // Limiar absoluto: primeiro mínimo local baixo o limiar
+      if (bestLag < 0 && tau > mMinLag + 1 && mDiff[tau - 1] < kYinThreshold &&
+          mDiff[tau - 1] <= mDiff[tau]) {
+        bestLag = tau - 1;
+        break;
+      }
+    }
+
+    if (bestLag < 0) {
+      mConfidence = 0.0f;
+      mFrequency = 0.0f;
+      return;
+    }
+
+    // Interpolación parabólica arredor do mínimo. Só se a parábola é
+    // convexa (no primeiro lag válido pode non selo) e sen saír de
+    // medio lag, así que refined queda en (mMinLag, mMaxLag]
+    float refined = static_cast<float>(bestLag);
+    float a = mDiff[bestLag - 1];
+    float b = mDiff[bestLag];
+    float c = mDiff[bestLag + 1];
+    float denom = a - 2.0f * b + c;
+    if (denom > 1e-9f)
+      refined += std::clamp(0.5f * (a - c) / denom, -0.5f, 0.5f);
+
+    mConfidence = std::clamp(1.0f - b, 0.0f, 1.0f);
+    mFrequency = mRate / refined;
+  }
+};
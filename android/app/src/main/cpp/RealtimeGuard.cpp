@@ -0,0 +1,32 @@
+#include "RealtimeGuard.h"
+
+#ifndef NDEBUG
+#include <android/log.h>
+#include <cstdlib>
+#include <new>
+
+#define LOG_TAG "RealtimeGuard"
+
+static thread_local bool tInRealtimeScope = false;
+
+ScopedRealtimeGuard::ScopedRealtimeGuard() { tInRealtimeScope = true; }
+
+ScopedRealtimeGuard::~ScopedRealtimeGuard() { tInRealtimeScope = false; }
+
+void *operator new(std::size_t size) {
+  if (tInRealtimeScope) {
+    tInRealtimeScope = false; // Evitar recursión se o log reserva memoria
+    __android_log_print(ANDROID_LOG_FATAL, LOG_TAG,
+                        "Allocation of %zu bytes on the audio thread", size);
+    std::abort();
+  }
+  void *ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+
+/**
+ * Garda de depuración para o fío de audio.
+ *
+ * Mentres hai un ScopedRealtimeGuard vivo no fío actual, calquera
+ * operator new aborta cun erro no log (só en builds sen NDEBUG; en release
+ * a garda non fai nada).
+ */
+#ifndef NDEBUG
+class ScopedRealtimeGuard {
+public:
+  ScopedRealtimeGuard();
+  ~ScopedRealtimeGuard();
+};
+#else
+class ScopedRealtimeGuard {};
+#endif
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Escala común de codificación e decodificación: decode(encode(x)) = x
+// con ±0.5 LSB. +1.0 satura en 32767
+static constexpr float kInt16Scale = 32768.0f;
+static constexpr float kInt16ToFloat = 1.0f / kInt16Scale;
+
+/**
+ * Conversión int16 -> float (NEON / SSE2, 8 mostras por iteración).
+ */
+inline void decodeSamples(const int16_t *src, float *dst, int count) {
+  int i = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+  const float32x4_t scale = vdupq_n_f32(kInt16ToFloat);
+  for (; i + 8 <= count; i += 8) {
+    int16x8_t s = vld1q_s16(src + i);
+    float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(s)));
+    float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(s)));
+    vst1q_f32(dst + i, vmulq_f32(lo, scale));
+    vst1q_f32(dst + i + 4, vmulq_f32(hi, scale));
+  }
+#elif defined(__SSE2__)
+  const __m128 scale = _mm_set1_ps(kInt16ToFloat);
+  for (; i + 8 <= count; i += 8) {
+    __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    // Estender o signo: duplicar en 32 bits e desprazar
+    __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+    __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+    _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+  }
+#endif
+  for (; i < count; i++)
+    dst[i] = src[i] * kInt16ToFloat;
+}
+
+/**
+ * Conversión float -> int16 con saturación (fóra do callback).
+ */
+inline void encodeSamples(const float *src, int16_t *dst, int count) {
+  for (int i = 0; i < count; i++) {
+    float v = std::clamp(src[i] * kInt16Scale, -32768.0f, 32767.0f);
+    dst[i] = static_cast<int16_t>(v >= 0.0f ? v + 0.5f : v - 0.5f);
+  }
+}
+
+/**
+ * Almacén de audio mono en int16: a metade de memoria que float e menos
+ * presión na caché ao ler. Decodifícase a float no momento de usalo.
+ */
+class SampleBuffer {
+public:
+  void assign(const float *data, int32_t numSamples) {
+    mData.resize(numSamples);
+    encodeSamples(data, mData.data(), numSamples);
+  }
+
+  void append(const float *data, int32_t numSamples) {
+    size_t oldSize = mData.size();
+    mData.resize(oldSize + numSamples);
+    encodeSamples(data, mData.data() + oldSize, numSamples);
+  }
+
+  /**
+   * Engade sen realocar (seguro no callback): copia só o que colle na
+   * capacidade reservada e devolve o número de mostras engadidas.
+   */
+  int32_t appendWithinCapacity(const float *data, int32_t numSamples) {
+    size_t oldSize = mData.size();
+    size_t room = mData.capacity() - oldSize;
+    int32_t n = static_cast<int32_t>(
+        std::min(room, static_cast<size_t>(std::max(numSamples, 0))));
+    mData.resize(oldSize + n);
+    encodeSamples(data, mData.data() + oldSize, n);
+    return n;
+  }
+
+  void reserve(size_t numSamples) { mData.reserve(numSamples); }
+  void clear() { mData.clear(); }
+  // Libera tamén a memoria reservada
+  void release() { std::vector<int16_t>().swap(mData); }
+
+  bool empty() const { return mData.empty(); }
+  int32_t size() const { return static_cast<int32_t>(mData.size()); }
+  const int16_t *data() const { return mData.data(); }
+  size_t memoryBytes() const { return mData.capacity() * sizeof(int16_t); }
+
+private:
+  std::vector<int16_t> mData;
+};
+
+/**
+ * Entrega dun SampleBuffer da UI ao callback sen locks (triple buffer).
+ *
+ * A UI enche back() e chama publish(); o callback chama acquire() ao
+ * comezo de cada bloque e, se devolve true, pasa a ler front(). Cada fío
+ * ten o seu slot en exclusiva e o terceiro intercámbiase atomicamente, así
+ * que a UI nunca escribe nun buffer que o callback poida estar lendo.
+ */
+class SampleBufferHandoff {
+public:
+  // Fío da UI: buffer libre para encher
+  SampleBuffer &back() { return mSlots[mBack]; }
+
+  // Fío da UI: entrega back() ao callback. O slot que volve era o que o
+  // callback deixou (ou unha entrega que nunca chegou a ler): libérase
+  void publish() {
+    mLatest = mBack;
+    int old = mMiddle.exchange(mBack | kDirty, std::memory_order_acq_rel);
+    mBack = old & kIndexMask;
+    mSlots[mBack].release();
+  }
+
+  // Fío da UI: o último buffer publicado (só lectura ata o seguinte publish)
+  const SampleBuffer &latest() const { return mSlots[mLatest]; }
+
+  // Callback: true se hai un buffer novo en front()
+  bool acquire() {
+    if (!(mMiddle.load(std::memory_order_relaxed) & kDirty))
+      return false;
+    int old = mMiddle.exchange(mFront, std::memory_order_acq_rel);
+    mFront = old & kIndexMask;
+    return true;
+  }
+
+  // Callback: buffer en uso
+  const SampleBuffer &front() const { return mSlots[mFront]; }
+
+  // Fío da UI
+  size_t memoryBytes() const {
+    return mSlots[0].memoryBytes() + mSlots[1].memoryBytes() +
+           mSlots[2].memoryBytes();
+  }
+
+private:
+  static constexpr int kIndexMask = 3;
+  static constexpr int kDirty = 4;
+
+  std::array<SampleBuffer, 3> mSlots;
+  int mBack = 0;   // UI
+  int mLatest = 1; // UI
+  int mFront = 1;  // Callback
+  std::atomic<int> mMiddle{2};
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "CpuFeatures.h"
+#include "SampleBuffer.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+/**
+ * Lector de buffer en bucle con velocidade variable.
+ *
+ * Mantén unha posición fraccionaria e interpola con Hermite cúbico. O
+ * punto de bucle suavízase cun crossfade: nas últimas kMaxCrossfade
+ * mostras mestúrase o comezo do ficheiro, e ao saltar retómase despois
+ * desa zona, polo que non hai clic aínda que o loop non sexa perfecto.
+ *
+ * O render faise en dúas pasadas: unha serie que avanza a posición e
+ * recolle os catro taps (xa mesturados co crossfade), e outra sen
+ * dependencias que avalía o polinomio e vectoriza ben.
+ */
+class SampleReader {
+public:
+  static constexpr int kBlockSize = 256;
+  static constexpr int32_t kMaxCrossfade = 2048; // ~43ms @ 48kHz
+  static constexpr float kMinRate = 0.25f;
+  static constexpr float kMaxRate = 4.0f;
+
+  // O lector non copia os datos: o buffer debe vivir mentres se usa
+  void setSource(const int16_t *data, int32_t numSamples) {
+    mData = data;
+    mLength = numSamples;
+    mCrossfade = std::min(kMaxCrossfade, numSamples / 4);
+    mLoopStart = mCrossfade;
+    mPosition = 0.0;
+  }
+
+  void reset() { mPosition = 0.0; }
+
+  // Posición de lectura (para capturar e reproducir sesións)
+  double getPosition() const { return mPosition; }
+  void setPosition(double position) { mPosition = position; }
+
+  bool isEmpty() const { return mData == nullptr || mLength < 4; }
+
+  /**
+   * Xera numFrames mostras. rates[i] é o avance por mostra (1.0 = orixinal).
+   * output pode ser o mesmo buffer que rates.
+   */
+  VOCODER_ALWAYS_INLINE void render(float *output, const float *rates,
+                                    int numFrames) {
+    if (isEmpty()) {
+      std::fill(output, output + numFrames, 0.0f);
+      return;
+    }
+
+    for (int offset = 0; offset < numFrames; offset += kBlockSize) {
+      int n = std::min(kBlockSize, numFrames - offset);
+      gatherTaps(rates + offset, n);
+      interpolate(output + offset, n);
+    }
+  }
+
+private:
+  const int16_t *mData = nullptr;
+  int32_t mLength = 0;
+  int32_t mCrossfade = 0;
+  int32_t mLoopStart = 0;
+  double mPosition = 0.0;
+
+  // Taps en formato SoA para a pasada de interpolación
+  std::array<float, kBlockSize> mTapPrev{};
+  std::array<float, kBlockSize> mTap0{};
+  std::array<float, kBlockSize> mTap1{};
+  std::array<float, kBlockSize> mTapNext{};
+  std::array<float, kBlockSize> mFrac{};
+
+  // Mostra no índice i (pode exceder o final do bucle) con crossfade
+  VOCODER_ALWAYS_INLINE float at(int32_t i) const {
+    const int32_t loopLength = mLength - mLoopStart;
+    if (i >= mLength)
+      i -= loopLength;
+    if (i < 0)
+      i = 0;
+
+    float sample = mData[i] * kInt16ToFloat;
+    int32_t fadeStart = mLength - mCrossfade;
+    if (mCrossfade > 0 && i >= fadeStart) {
+      float w = static_cast<float>(i - fadeStart) / mCrossfade;
+      sample += w * (mData[i - loopLength] * kInt16ToFloat - sample);
+    }
+    return sample;
+  }
+
+  VOCODER_ALWAYS_INLINE void gatherTaps(const float *rates, int n) {
+    const double loopLength = mLength - mLoopStart;
+    for (int i = 0; i < n; i++) {
+      int32_t idx = static_cast<int32_t>(mPosition);
+      mFrac[i] = static_cast<float>(mPosition - idx);
+      mTapPrev[i] = at(idx - 1);
+      mTap0[i] = at(idx);
+      mTap1[i] = at(idx + 1);
+      mTapNext[i] = at(idx + 2);
+
+      mPosition += std::clamp(rates[i], kMinRate, kMaxRate);
+      if (mPosition >= mLength)
+        mPosition -= loopLength;
+    }
+  }
+
+  VOCODER_ALWAYS_INLINE void interpolate(float *output, int n) const {
+    // Hermite cúbico (Catmull-Rom)
+    for (int i = 0; i < n; i++) {
+      float xm1 = mTapPrev[i], x0 = mTap0[i], x1 = mTap1[i], x2 = mTapNext[i];
+      float t = mFrac[i];
+      float c1 = 0.5f * (x1 - xm1);
+      float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+      float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+      output[i] = ((c3 * t + c2) * t + c1) * t + x0;
+    }
+  }
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ParameterMailbox.h"
+#include <cstdint>
+
+/**
+ * Formato binario das sesións capturadas (little-endian, sen padding).
+ *
+ *   SessionHeader
+ *   rexistros: uint8_t tag + corpo
+ *     Block:   SessionBlock + numFrames floats do modulador
+ *     Param:   SessionParam
+ *     Carrier: SessionCarrier + numSamples int16 do carrier externo
+ *     Gap:     SessionGap (o buffer de captura encheuse e perdéronse
+ *              rexistros: a partir de aí o replay xa non é comparable)
+ *
+ * Os parámetros aplícanse antes do bloque seguinte, como no callback. O
+ * procesador do replay parte do estado inicial co snapshot de parámetros
+ * escrito ao comezo, así que a saída do replay é unha función exacta do
+ * ficheiro.
+ */
+namespace session {
+
+static constexpr char kMagic[4] = {'G', 'V', 'S', 'N'};
+static constexpr uint32_t kVersion = 1;
+
+enum class Tag : uint8_t { Block = 1, Param = 2, Carrier = 3, Gap = 4 };
+
+// Flags de SessionBlock
+static constexpr uint8_t kBlockExtCarrier = 1;
+
+#pragma pack(push, 1)
+struct SessionHeader {
+  char magic[4];
+  uint32_t version;
+  float sampleRate;
+  uint32_t numBands;
+  char filterName[32]; // Topoloxía do banco de filtros que a gravou
+};
+
+struct SessionBlock {
+  uint64_t frame; // Posición do primeiro frame desde o comezo da captura
+  uint32_t numFrames;
+  uint8_t flags;
+  uint32_t carrierId;      // Carrier activo (SessionCarrier::id)
+  double carrierPosition;  // Posición do SampleReader ao comezo do bloque
+};
+
+struct SessionParam {
+  uint64_t frame;
+  ParamChange change;
+};
+
+struct SessionCarrier {
+  uint32_t id;
+  uint32_t numSamples;
+};
+
+struct SessionGap {
+  uint64_t frame; // Último frame con rexistros perdidos
+  uint32_t droppedRecords;
+};
+#pragma pack(pop)
+
+} // namespace session
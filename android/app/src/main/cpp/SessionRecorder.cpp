@@ -0,0 +1,197 @@
+#include "SessionRecorder.h"
+#include <algorithm>
+#include <android/log.h>
+#include <chrono>
+#include <cstring>
+
+#define LOG_TAG "SessionRecorder"
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+
+static constexpr size_t kRingMask = SessionRecorder::kRingBytes - 1;
+static_assert((SessionRecorder::kRingBytes & kRingMask) == 0,
+              "Ring size must be a power of two");
+
+SessionRecorder::~SessionRecorder() { stop(); }
+
+bool SessionRecorder::start(const char *path, float sampleRate, int numBands,
+                            const char *filterName) {
+  if (mWriter.joinable()) {
+    LOGE("Capture already running");
+    return false;
+  }
+
+  mFile = std::fopen(path, "wb");
+  if (mFile == nullptr) {
+    LOGE("Cannot open capture file %s", path);
+    return false;
+  }
+
+  session::SessionHeader header{};
+  std::memcpy(header.magic, session::kMagic, sizeof(header.magic));
+  header.version = session::kVersion;
+  header.sampleRate = sampleRate;
+  header.numBands = static_cast<uint32_t>(numBands);
+  std::strncpy(header.filterName, filterName, sizeof(header.filterName) - 1);
+  mFailed = false;
+  if (!writeFile(&header, sizeof(header))) {
+    std::fclose(mFile);
+    mFile = nullptr;
+    return false;
+  }
+
+  // O buffer resérvase unha vez e consérvase entre capturas
+  if (mRing.empty())
+    mRing.resize(kRingBytes);
+  mReadPos.store(mWritePos.load(std::memory_order_acquire),
+                 std::memory_order_release);
+  mReportedDrops = mDroppedRecords.load(std::memory_order_relaxed);
+
+  mSession.fetch_add(1, std::memory_order_release);
+  mActive.store(true, std::memory_order_release);
+  mWriter = std::thread(&SessionRecorder::writerLoop, this);
+  LOGI("Session capture started: %s", path);
+  return true;
+}
+
+bool SessionRecorder::stop() {
+  if (!mWriter.joinable())
+    return true;
+  mActive.store(false, std::memory_order_release);
+  mWriter.join();
+
+  {
+    std::lock_guard<std::mutex> lock(mCarrierMutex);
+    mPendingCarriers.clear();
+  }
+  long bytes = std::ftell(mFile);
+  // fclose escribe o que quede no buffer de stdio: tamén pode fallar
+  if (std::fclose(mFile) != 0)
+    mFailed = true;
+  mFile = nullptr;
+  if (mFailed) {
+    LOGE("Session capture failed: file is incomplete (%ld bytes)", bytes);
+    return false;
+  }
+  LOGI("Session capture stopped (%ld bytes)", bytes);
+  return true;
+}
+
+void SessionRecorder::writeCarrier(uint32_t id, const int16_t *data,
+                                   int32_t numSamples) {
+  if (!isActive())
+    return;
+  std::lock_guard<std::mutex> lock(mCarrierMutex);
+  mPendingCarriers.push_back({id, std::vector<int16_t>(data, data + numSamples)});
+}
+
+void SessionRecorder::writeParam(uint64_t frame, const ParamChange &change) {
+  session::SessionParam record{frame, change};
+  push(session::Tag::Param, frame, &record, sizeof(record), nullptr, 0);
+}
+
+void SessionRecorder::writeBlock(const session::SessionBlock &block,
+                                 const float *input) {
+  push(session::Tag::Block, block.frame, &block, sizeof(block), input,
+       block.numFrames * sizeof(float));
+}
+
+bool SessionRecorder::push(session::Tag tag, uint64_t frame,
+                           const void *header, size_t headerBytes,
+                           const void *payload, size_t payloadBytes) {
+  const size_t total = 1 + headerBytes + payloadBytes;
+  size_t write = mWritePos.load(std::memory_order_relaxed);
+  size_t read = mReadPos.load(std::memory_order_acquire);
+  if (kRingBytes - (write - read) < total) {
+    mLastDroppedFrame.store(frame, std::memory_order_relaxed);
+    mDroppedRecords.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  copyIn(write, &tag, 1);
+  copyIn(write + 1, header, headerBytes);
+  if (payloadBytes > 0)
+    copyIn(write + 1 + headerBytes, payload, payloadBytes);
+  mWritePos.store(write + total, std::memory_order_release);
+  return true;
+}
+
+void SessionRecorder::copyIn(size_t pos, const void *src, size_t bytes) {
+  size_t start = pos & kRingMask;
+  size_t first = std::min(bytes, kRingBytes - start);
+  std::memcpy(mRing.data() + start, src, first);
+  if (first < bytes)
+    std::memcpy(mRing.data(), static_cast<const uint8_t *>(src) + first,
+                bytes - first);
+}
+
+bool SessionRecorder::writeFile(const void *data, size_t bytes) {
+  if (mFailed)
+    return false;
+  if (std::fwrite(data, 1, bytes, mFile) != bytes) {
+    LOGE("Session capture write failed");
+    mFailed = true;
+  }
+  return !mFailed;
+}
+
+void SessionRecorder::writerLoop() {
+  while (true) {
+    // Ler o estado antes de vaciar: o que chegue despois de parar xa non
+    // pertence a esta captura
+    bool active = isActive();
+    flushCarriers();
+    flushRing();
+    flushGaps();
+    if (!active)
+      break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  }
+  if (!mFailed && std::fflush(mFile) != 0) {
+    LOGE("Session capture write failed");
+    mFailed = true;
+  }
+}
+
+void SessionRecorder::flushRing() {
+  size_t read = mReadPos.load(std::memory_order_relaxed);
+  size_t write = mWritePos.load(std::memory_order_acquire);
+  while (read != write) {
+    size_t start = read & kRingMask;
+    size_t n = std::min(write - read, kRingBytes - start);
+    writeFile(mRing.data() + start, n);
+    read += n;
+  }
+  mReadPos.store(read, std::memory_order_release);
+}
+
+void SessionRecorder::flushCarriers() {
+  std::vector<PendingCarrier> pending;
+  {
+    std::lock_guard<std::mutex> lock(mCarrierMutex);
+    pending.swap(mPendingCarriers);
+  }
+  for (const auto &carrier : pending) {
+    auto tag = session::Tag::Carrier;
+    session::SessionCarrier record{
+        carrier.id, static_cast<uint32_t>(carrier.samples.size())};
+    writeFile(&tag, 1);
+    writeFile(&record, sizeof(record));
+    writeFile(carrier.samples.data(),
+              carrier.samples.size() * sizeof(int16_t));
+  }
+}
+
+void SessionRecorder::flushGaps() {
+  uint32_t dropped = mDroppedRecords.load(std::memory_order_relaxed);
+  if (dropped == mReportedDrops)
+    return;
+
+  auto tag = session::Tag::Gap;
+  session::SessionGap record{mLastDroppedFrame.load(std::memory_order_relaxed),
+                             dropped - mReportedDrops};
+  writeFile(&tag, 1);
+  writeFile(&record, sizeof(record));
+  LOGE("Session capture dropped %u records", record.droppedRecords);
+  mReportedDrops = dropped;
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "SessionFormat.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Captura de sesións para reproducir e perfilar no host (ver
+ * SessionFormat.h e tools/session_replay).
+ *
+ * O callback escribe os rexistros nun buffer circular SPSC reservado ao
+ * iniciar a captura, sen locks nin reservas; un fío en segundo plano
+ * vacíao ao ficheiro. Se o buffer se enche, os rexistros descártanse e
+ * o fío escribe un rexistro Gap.
+ */
+class SessionRecorder {
+public:
+  static constexpr size_t kRingBytes = 1 << 21; // ~10 s de modulador
+
+  ~SessionRecorder();
+
+  // Fío da UI
+  bool start(const char *path, float sampleRate, int numBands,
+             const char *filterName);
+  // false se fallou algunha escritura: o ficheiro queda incompleto
+  bool stop();
+  void writeCarrier(uint32_t id, const int16_t *data, int32_t numSamples);
+
+  bool isActive() const { return mActive.load(std::memory_order_acquire); }
+  // Cambia en cada start(): o callback detecta así unha captura nova
+  uint32_t getSession() const {
+    return mSession.load(std::memory_order_acquire);
+  }
+
+  // Fío de audio
+  void writeParam(uint64_t frame, const ParamChange &change);
+  void writeBlock(const session::SessionBlock &block, const float *input);
+
+private:
+  std::vector<uint8_t> mRing;
+  // Posicións monotónicas (produtor e consumidor en liñas distintas)
+  alignas(64) std::atomic<size_t> mWritePos{0};
+  std::atomic<uint32_t> mDroppedRecords{0};
+  std::atomic<uint64_t> mLastDroppedFrame{0};
+  alignas(64) std::atomic<size_t> mReadPos{0};
+
+  std::atomic<bool> mActive{false};
+  std::atomic<uint32_t> mSession{0};
+  std::thread mWriter;
+  FILE *mFile = nullptr;
+  uint32_t mReportedDrops = 0;
+  // Escritura fallida (disco cheo...): o fío segue vaciando o buffer pero
+  // xa non escribe. Só o fío escritor ata o join de stop()
+  bool mFailed = false;
+
+  // Carriers pendentes de escribir (só fíos non real-time)
+  struct PendingCarrier {
+    uint32_t id;
+    std::vector<int16_t> samples;
+  };
+  std::mutex mCarrierMutex;
+  std::vector<PendingCarrier> mPendingCarriers;
+
+  bool push(session::Tag tag, uint64_t frame, const void *header,
+            size_t headerBytes, const void *payload, size_t payloadBytes);
+  void copyIn(size_t pos, const void *src, size_t bytes);
+  bool writeFile(const void *data, size_t bytes);
+  void writerLoop();
+  void flushRing();
+  void flushCarriers();
+  void flushGaps();
+};
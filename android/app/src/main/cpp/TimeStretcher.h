@@ -0,0 +1,209 @@
+#pragma once
+
+#include "SampleBuffer.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Time-stretch WSOLA para reproducir un buffer en bucle a velocidade
+ * variable (0.25x - 2x) sen cambiar o ton.
+ *
+ * Cada salto de síntese (kHop = 256 mostras, un callback) colócase un
+ * frame con xanela Hann de kFrameSize mostras. A súa posición no buffer
+ * é a nominal (avanza speed * kHop) axustada ±kTolerance para maximizar
+ * a correlación normalizada coa continuación natural do frame anterior.
+ * A busca é grosa (paso kCoarseStep) e logo fina arredor do mellor
+ * candidato, sempre co mesmo número de produtos escalares: o custo por
+ * salto é constante.
+ */
+class TimeStretcher {
+public:
+  static constexpr int kFrameSize = 1024;
+  static constexpr int kHop = 256;
+  static constexpr int kCorrLength = 512;
+  static constexpr int kTolerance = 256;
+  static constexpr int kCoarseStep = 4;
+  static constexpr float kMinSpeed = 0.25f;
+  static constexpr float kMaxSpeed = 2.0f;
+
+  TimeStretcher(float sampleRate) : mSampleRate(sampleRate) {
+    // Hann periódica: catro xanelas solapadas ao 75% suman 2.0
+    for (int i = 0; i < kFrameSize; i++) {
+      mWindow[i] = 0.5f * (0.5f - 0.5f * std::cos(2.0f * M_PI * i / kFrameSize));
+    }
+  }
+
+  // O lector non copia os datos: o buffer debe vivir mentres se usa
+  void setSource(const int16_t *data, int32_t numSamples) {
+    mData = data;
+    mLength = numSamples;
+    reset();
+  }
+
+  void setSpeed(float speed) {
+    mSpeed = std::clamp(speed, kMinSpeed, kMaxSpeed);
+  }
+
+  void reset() {
+    mNominal = 0.0;
+    mPrevPosition = 0;
+    mPrimed = false;
+    mAccumulator.fill(0.0f);
+    mHopReadPos = kHop;
+  }
+
+  bool isEmpty() const { return mData == nullptr || mLength <= 0; }
+
+  void render(float *output, int numFrames) {
+    if (isEmpty()) {
+      std::fill(output, output + numFrames, 0.0f);
+      return;
+    }
+
+    int written = 0;
+    while (written < numFrames) {
+      if (mHopReadPos == kHop) {
+        synthesiseHop();
+        mHopReadPos = 0;
+      }
+      int n = std::min(numFrames - written, kHop - mHopReadPos);
+      std::memcpy(output + written, mHopOutput.data() + mHopReadPos,
+                  n * sizeof(float));
+      mHopReadPos += n;
+      written += n;
+    }
+  }
+
+  // Custo medio dun salto, en ns e en % do tempo real que produce
+  float getHopNs() const { return mHopNs; }
+  float getCpuLoad() const {
+    float hopNs = kHop * 1.0e9f / mSampleRate;
+    return mHopNs / hopNs;
+  }
+
+private:
+  float mSampleRate;
+  const int16_t *mData = nullptr;
+  int32_t mLength = 0;
+  float mSpeed = 1.0f;
+
+  double mNominal = 0.0;
+  int32_t mPrevPosition = 0;
+  bool mPrimed = false;
+  int mHopReadPos = kHop;
+  float mHopNs = 0.0f;
+
+  std::array<float, kFrameSize> mWindow{};
+  std::array<float, kFrameSize> mAccumulator{};
+  std::array<float, kFrameSize> mFrame{};
+  std::array<float, kHop> mHopOutput{};
+  std::array<float, kCorrLength> mTemplate{};
+  std::array<float, kCorrLength + 2 * kTolerance> mRegion{};
+  std::array<float, kCorrLength + 2 * kTolerance + 1> mRegionEnergy{};
+
+  int32_t wrap(int64_t index) const {
+    int64_t r = index % mLength;
+    return static_cast<int32_t>(r < 0 ? r + mLength : r);
+  }
+
+  // Decodifica count mostras desde start, dando a volta ao final do buffer
+  void copySegment(float *dest, int64_t start, int count) const {
+    int32_t idx = wrap(start);
+    while (count > 0) {
+      int n = std::min(count, static_cast<int>(mLength - idx));
+      decodeSamples(mData + idx, dest, n);
+      dest += n;
+      count -= n;
+      idx = 0;
+    }
+  }
+
+  static float dot(const float *a, const float *b, int n) {
+    float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+      s0 += a[i] * b[i];
+      s1 += a[i + 1] * b[i + 1];
+      s2 += a[i + 2] * b[i + 2];
+      s3 += a[i + 3] * b[i + 3];
+    }
+    for (; i < n; i++)
+      s0 += a[i] * b[i];
+    return (s0 + s1) + (s2 + s3);
+  }
+
+  float score(int offset) const {
+    float energy = mRegionEnergy[offset + kCorrLength] - mRegionEnergy[offset];
+    return dot(mTemplate.data(), mRegion.data() + offset, kCorrLength) /
+           std::sqrt(energy + 1e-9f);
+  }
+
+  // Desprazamento (0..2*kTolerance) co que mellor encaixa o frame
+  int findBestOffset() {
+    mRegionEnergy[0] = 0.0f;
+    for (int i = 0; i < static_cast<int>(mRegion.size()); i++)
+      mRegionEnergy[i + 1] = mRegionEnergy[i] + mRegion[i] * mRegion[i];
+
+    int best = kTolerance;
+    float bestScore = score(best);
+    for (int offset = 0; offset <= 2 * kTolerance; offset += kCoarseStep) {
+      float s = score(offset);
+      if (s > bestScore) {
+        bestScore = s;
+        best = offset;
+      }
+    }
+
+    int coarse = best;
+    int lo = std::max(0, coarse - kCoarseStep + 1);
+    int hi = std::min(2 * kTolerance, coarse + kCoarseStep - 1);
+    for (int offset = lo; offset <= hi; offset++) {
+      float s = score(offset);
+      if (s > bestScore) {
+        bestScore = s;
+        best = offset;
+      }
+    }
+    return best;
+  }
+
+  void synthesiseHop() {
+    auto t0 = std::chrono::steady_clock::now();
+
+    int32_t position;
+    if (!mPrimed) {
+      position = wrap(static_cast<int64_t>(mNominal));
+      mPrimed = true;
+    } else {
+      mNominal += mSpeed * kHop;
+      if (mNominal >= mLength)
+        mNominal -= mLength * std::floor(mNominal / mLength);
+
+      // Plantilla: como continuaría o frame anterior sen saltos
+      copySegment(mTemplate.data(), static_cast<int64_t>(mPrevPosition) + kHop,
+                  kCorrLength);
+      int64_t searchStart = static_cast<int64_t>(mNominal) - kTolerance;
+      copySegment(mRegion.data(), searchStart, mRegion.size());
+      position = wrap(searchStart + findBestOffset());
+    }
+    mPrevPosition = position;
+
+    // Overlap-add do novo frame
+    copySegment(mFrame.data(), position, kFrameSize);
+    for (int i = 0; i < kFrameSize; i++)
+      mAccumulator[i] += mFrame[i] * mWindow[i];
+
+    std::memcpy(mHopOutput.data(), mAccumulator.data(), kHop * sizeof(float));
+    std::memmove(mAccumulator.data(), mAccumulator.data() + kHop,
+                 (kFrameSize - kHop) * sizeof(float));
+    std::fill(mAccumulator.end() - kHop, mAccumulator.end(), 0.0f);
+
+    auto t1 = std::chrono::steady_clock::now();
+    float ns = std::chrono::duration<float, std::nano>(t1 - t0).count();
+    mHopNs = 0.95f * mHopNs + 0.05f * ns;
+  }
+};
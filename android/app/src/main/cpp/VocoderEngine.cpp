@@ -1,58 +1,171 @@
 #include "VocoderEngine.h"
+#include "RealtimeGuard.h"
 #include <algorithm>
 #include <android/log.h>
+#include <chrono>
+#include <cmath>
+#include <thread>
 
 #define LOG_TAG "VocoderEngine"
 #define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
 
 VocoderEngine::VocoderEngine() {
-  mProcessor = std::make_unique<VocoderProcessor>(kSampleRate);
-  mInputBuffer.resize(kFramesPerBuffer, 0.0f);
-  mOutputBuffer.resize(kFramesPerBuffer, 0.0f);
-  mWaveformBuffer.resize(256, 0.0f);
-  // Pre-alocar buffers de traballo para evitar asignacións no callback
-  mCarrierWorkBuffer.resize(kFramesPerBuffer, 0.0f);
-  mMicWorkBuffer.resize(kFramesPerBuffer, 0.0f);
-  mRecordedData.reserve(kSampleRate * 10); // Reservar para 10 segundos
-  LOGI("VocoderEngine created");
+  // Todo o estado do callback (incluídos os buffers de traballo ao tamaño
+  // máximo de burst) resérvase aquí, nunha soa vez
+  mState = std::make_unique<EngineState>(kSampleRate);
+  mRecorder = std::make_unique<SessionRecorder>();
+  LOGI("VocoderEngine created (band filter: %s)",
+       VocoderProcessor::getFilterName());
+  setKernelVariant(-1);
 }
 
 VocoderEngine::~VocoderEngine() {
-  stop();
+  // Desde aquí o fío de erros de Oboe ignora os erros novos
+  mShuttingDown = true;
+
+  std::shared_ptr<oboe::AudioStream> input;
+  std::shared_ptr<oboe::AudioStream> output;
+  {
+    std::lock_guard<std::mutex> lock(mLifecycleMutex);
+    mIsRunning = false;
+    input = std::move(mInputStream);
+    output = std::move(mOutputStream);
+  }
+  // Fóra do lock: pechar un stream pode agardar polo seu fío de erros,
+  // que á súa vez pode estar esperando polo lock
+  closeStream(output);
+  closeStream(input);
+
+  // Un erro que entrou antes de mShuttingDown aínda usa os membros
+  while (mErrorCallbacksActive.load() > 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
   LOGI("VocoderEngine destroyed");
 }
 
+bool VocoderEngine::prepare() {
+  std::lock_guard<std::mutex> lock(mLifecycleMutex);
+  if (mInputStream && mOutputStream)
+    return true;
+  return openStreams();
+}
+
 bool VocoderEngine::start() {
+  std::lock_guard<std::mutex> lock(mLifecycleMutex);
   if (mIsRunning)
     return true;
 
-  createStreams();
-
-  if (mInputStream && mOutputStream) {
-    auto res1 = mInputStream->requestStart();
-    auto res2 = mOutputStream->requestStart();
+  auto t0 = std::chrono::steady_clock::now();
 
-    if (res1 == oboe::Result::OK && res2 == oboe::Result::OK) {
-      mIsRunning = true;
-      LOGI("VocoderEngine started successfully");
-      return true;
-    } else {
-      LOGE("Failed to requestStart: input=%d, output=%d", (int)res1, (int)res2);
-    }
+  // Warm start se os streams xa estaban abertos en standby
+  bool warm = mInputStream && mOutputStream;
+  if (!warm && !openStreams()) {
+    LOGE("Failed to start VocoderEngine - streams null or open failed");
+    return false;
   }
 
-  LOGE("Failed to start VocoderEngine - streams null or open failed");
-  return false;
+  if (!startStreams()) {
+    closeStreams();
+    return false;
+  }
+  mIsRunning = true;
+
+  auto t1 = std::chrono::steady_clock::now();
+  float ms = std::chrono::duration<float, std::milli>(t1 - t0).count();
+  (warm ? mWarmStartMs : mColdStartMs).store(ms);
+  LOGI("VocoderEngine started successfully (%s start: %.2f ms)",
+       warm ? "warm" : "cold", ms);
+  return true;
 }
 
 void VocoderEngine::stop() {
+  std::lock_guard<std::mutex> lock(mLifecycleMutex);
   if (!mIsRunning)
     return;
 
   mIsRunning = false;
+  pauseStreams();
+  LOGI("VocoderEngine stopped (streams in standby)");
+}
+
+void VocoderEngine::release() {
+  std::lock_guard<std::mutex> lock(mLifecycleMutex);
+  if (mIsRunning || (!mInputStream && !mOutputStream))
+    return;
+
   closeStreams();
-  LOGI("VocoderEngine stopped");
+  LOGI("VocoderEngine released standby streams");
+}
+
+void VocoderEngine::onErrorAfterClose(oboe::AudioStream *stream,
+                                      oboe::Result error) {
+  // Contarse antes de comprobar o peche: o destrutor ou ve este erro
+  // activo e agarda, ou este erro ve o peche e non toca nada
+  mErrorCallbacksActive++;
+  struct ActiveGuard {
+    std::atomic<int> &count;
+    ~ActiveGuard() { count--; }
+  } guard{mErrorCallbacksActive};
+  if (mShuttingDown)
+    return;
+
+  std::lock_guard<std::mutex> lock(mLifecycleMutex);
+  if (mShuttingDown)
+    return;
+
+  // Erro dun stream que xa foi substituído (p.ex. o par desconectouse á vez)
+  if (stream != mInputStream.get() && stream != mOutputStream.get())
+    return;
+
+  LOGE("Stream closed by the system: %s. Reopening",
+       oboe::convertToText(error));
+
+  // Oboe pechou un dos streams: pechar o outro e abrir o par de novo.
+  // O procesador non se toca, polo que o son continúa igual.
+  closeStreams();
+  if (!openStreams()) {
+    mIsRunning = false;
+    LOGE("Failed to reopen streams after error");
+    return;
+  }
+  if (mIsRunning && !startStreams()) {
+    mIsRunning = false;
+    closeStreams();
+    return;
+  }
+  mReopenCount++;
+  LOGI("Streams reopened (%s)", mIsRunning ? "running" : "standby");
+}
+
+bool VocoderEngine::openStreams() {
+  createStreams();
+  if (mInputStream && mOutputStream)
+    return true;
+  closeStreams();
+  return false;
+}
+
+bool VocoderEngine::startStreams() {
+  auto res1 = mInputStream->requestStart();
+  auto res2 = mOutputStream->requestStart();
+  if (res1 != oboe::Result::OK || res2 != oboe::Result::OK) {
+    LOGE("Failed to requestStart: input=%d, output=%d", (int)res1, (int)res2);
+    return false;
+  }
+  return true;
+}
+
+void VocoderEngine::pauseStreams() {
+  // Saída primeiro para que o callback deixe de ler o micro.
+  // Os streams de entrada non admiten pausa: detense pero segue aberto.
+  if (mOutputStream) {
+    mOutputStream->pause();
+    mOutputStream->flush();
+  }
+  if (mInputStream) {
+    mInputStream->stop();
+  }
 }
 
 void VocoderEngine::createStreams() {
@@ -65,9 +178,10 @@ void VocoderEngine::createStreams() {
       // VoiceCommunication activa AEC, NS e AGC automaticamente
       ->setInputPreset(oboe::InputPreset::VoiceCommunication)
       ->setSampleRate(kSampleRate)
-      ->setChannelCount(kChannelCount)
+      ->setChannelCount(kInputChannelCount)
       ->setFormat(oboe::AudioFormat::Float)
-      ->setFramesPerDataCallback(kFramesPerBuffer);
+      ->setFramesPerDataCallback(kFramesPerBuffer)
+      ->setErrorCallback(this);
 
   auto inputResult = inputBuilder.openStream(mInputStream);
   if (inputResult != oboe::Result::OK) {
@@ -80,10 +194,11 @@ void VocoderEngine::createStreams() {
       ->setPerformanceMode(oboe::PerformanceMode::LowLatency)
       ->setSharingMode(oboe::SharingMode::Exclusive)
       ->setSampleRate(kSampleRate)
-      ->setChannelCount(kChannelCount)
+      ->setChannelCount(kOutputChannelCount)
       ->setFormat(oboe::AudioFormat::Float)
       ->setFramesPerDataCallback(kFramesPerBuffer)
-      ->setDataCallback(this);
+      ->setDataCallback(this)
+      ->setErrorCallback(this);
 
   auto outputResult = outputBuilder.openStream(mOutputStream);
   if (outputResult != oboe::Result::OK) {
@@ -92,38 +207,108 @@ void VocoderEngine::createStreams() {
 }
 
 void VocoderEngine::closeStreams() {
-  if (mInputStream) {
-    mInputStream->stop();
-    mInputStream->close();
-    mInputStream.reset();
-  }
-  if (mOutputStream) {
-    mOutputStream->stop();
-    mOutputStream->close();
-    mOutputStream.reset();
+  // Saída primeiro: o callback usa mInputStream
+  closeStream(mOutputStream);
+  closeStream(mInputStream);
+}
+
+void VocoderEngine::closeStream(std::shared_ptr<oboe::AudioStream> &stream) {
+  if (stream) {
+    stream->stop();
+    stream->close();
+    stream.reset();
   }
 }
 
 oboe::DataCallbackResult VocoderEngine::onAudioReady(oboe::AudioStream *stream,
                                                      void *audioData,
                                                      int32_t numFrames) {
+  ScopedRealtimeGuard realtimeGuard;
 
+  // Os buffers teñen tamaño fixo: bloques maiores procésanse por partes
   auto *outputData = static_cast<float *>(audioData);
+  constexpr int32_t kMaxFrames = EngineAudioState::kMaxCallbackFrames;
+  for (int32_t offset = 0; offset < numFrames; offset += kMaxFrames) {
+    renderChunk(outputData + offset * kOutputChannelCount,
+                std::min(kMaxFrames, numFrames - offset));
+  }
 
-  // Asegurar que os buffers teñan tamaño suficiente (só cambia en inicio)
-  if (mInputBuffer.size() < static_cast<size_t>(numFrames)) {
-    mInputBuffer.resize(numFrames, 0.0f);
-    mCarrierWorkBuffer.resize(numFrames, 0.0f);
-    mMicWorkBuffer.resize(numFrames, 0.0f);
+  return oboe::DataCallbackResult::Continue;
+}
+
+void VocoderEngine::renderChunk(float *outputData, int32_t numFrames) {
+  EngineControls &controls = mState->controls;
+  EngineMeters &meters = mState->meters;
+  EngineAudioState &audio = mState->audio;
+  float *inputBuffer = audio.inputBuffer.data();
+  float *micBuffer = audio.micBuffer.data();
+
+  // Cambios de parámetros da UI (e, se se está capturando, rexistralos co
+  // frame no que se aplican)
+  const bool capturing = mRecorder->isActive();
+  if (capturing && mRecorder->getSession() != audio.captureSession) {
+    // Captura nova: o procesador volve ao estado inicial e recibe os
+    // parámetros actuais na mesma orde que no replay, que parte dun
+    // procesador recén creado. Custa un corte breve na saída
+    audio.captureSession = mRecorder->getSession();
+    audio.captureFrame = 0;
+    audio.processor.reset();
+    controls.params.forEachSet([&](const ParamChange &change) {
+      applyParamChange(audio.processor, change);
+      mRecorder->writeParam(0, change);
+    });
+  }
+  // Variante dos kernels DSP (detectada ao crear o motor ou forzada)
+  const int kernels = controls.kernelVariant.load(std::memory_order_relaxed);
+  if (kernels != audio.kernelVariant) {
+    audio.kernelVariant = kernels;
+    audio.processor.setKernelVariant(static_cast<KernelVariant>(kernels));
+    for (LayerAudioState &layer : audio.layers) {
+      layer.processor.setKernelVariant(static_cast<KernelVariant>(kernels));
+    }
   }
 
-  // Usar buffers pre-alocados en lugar de crear novos vectores
-  std::fill(mCarrierWorkBuffer.begin(), mCarrierWorkBuffer.begin() + numFrames,
-            0.0f);
-  std::fill(mMicWorkBuffer.begin(), mMicWorkBuffer.begin() + numFrames, 0.0f);
+  controls.params.collect(audio.appliedParams, [&](const ParamChange &change) {
+    applyParamChange(audio.processor, change);
+    if (capturing)
+      mRecorder->writeParam(audio.captureFrame, change);
+  });
+
+  // Capas adicionais (non se capturan: o replay só reproduce a principal)
+  bool layered = false;
+  for (int i = 0; i < kMaxLayers - 1; i++) {
+    LayerAudioState &layer = audio.layers[i];
+    bool active = controls.layers[i].active.load(std::memory_order_acquire);
+    layer.active = active;
+    if (!active)
+      continue;
+    // Capa nova (aínda que se destruíse e crease entre dous bloques): parte
+    // dos valores por defecto, sen estado nin parámetros da anterior. Os
+    // da principal chegan polo mailbox (ver createLayer); o carrier
+    // externo, que a principal non pasa polo mailbox, cópiase aquí
+    uint32_t generation =
+        controls.layers[i].generation.load(std::memory_order_relaxed);
+    if (generation != layer.generation) {
+      layer.processor.reset();
+      layer.carrierReader.reset();
+      layer.extCarrier =
+          controls.waveformType.load(std::memory_order_relaxed) == 4;
+      layer.generation = generation;
+    }
+    controls.layers[i].params.collect(
+        layer.appliedParams, [&](const ParamChange &change) {
+          if (change.id == ParamId::Waveform)
+            layer.extCarrier = change.a == 4;
+          applyParamChange(layer.processor, change);
+        });
+    layered = true;
+  }
+
+  std::fill(micBuffer, micBuffer + numFrames, 0.0f);
   bool hasExtCarrier = false;
 
   bool gotInput = false;
+  const int source = controls.source.load(std::memory_order_relaxed);
 
   // Siempre intentamos leer el micro si el stream está vivo, incluso si mSource
   // es File, para permitir la grabación de fondo o el VU meter global.
@@ -132,56 +317,74 @@ oboe::DataCallbackResult VocoderEngine::onAudioReady(oboe::AudioStream *stream,
 
   if (mInputStream && (inputState == oboe::StreamState::Started ||
                        inputState == oboe::StreamState::Starting)) {
-    auto result = mInputStream->read(mMicWorkBuffer.data(), numFrames, 0);
+    auto result = mInputStream->read(micBuffer, numFrames, 0);
     if (result.value() > 0) {
       // Si estamos grabando, guardar la señal del micro
-      if (mIsRecording) {
+      if (controls.isRecording.load(std::memory_order_relaxed)) {
         std::lock_guard<std::mutex> lock(mRecordingMutex);
-        mRecordedData.insert(mRecordedData.end(), mMicWorkBuffer.begin(),
-                             mMicWorkBuffer.begin() + result.value());
+        int32_t n = result.value();
+        if (mRecordedData.appendWithinCapacity(micBuffer, n) < n) {
+          // Capacidade esgotada: deter e avisar á UI, que chama a
+          // stopRecording() para cargar o gravado
+          controls.isRecording.store(false, std::memory_order_relaxed);
+          controls.recordingFull.store(true, std::memory_order_release);
+        }
       }
 
-      if (mSource.load() == 0 && mIsMicActive.load()) { // SOURCE_MIC y activo
-        std::copy(mMicWorkBuffer.begin(), mMicWorkBuffer.end(),
-                  mInputBuffer.begin());
+      if (source == 0 && controls.isMicActive.load(
+                             std::memory_order_relaxed)) { // SOURCE_MIC y activo
+        std::copy(micBuffer, micBuffer + numFrames, inputBuffer);
         gotInput = true;
       }
     }
   }
 
-  if (mSource.load() == 1) { // SOURCE_FILE
-    if (!mModulatorFileBuffer.empty() && mIsFilePlaying.load()) {
-      int32_t readIdx = mFileReadIndex.load();
-      for (int i = 0; i < numFrames; i++) {
-        mInputBuffer[i] = mModulatorFileBuffer[readIdx];
-        readIdx = (readIdx + 1) % (int32_t)mModulatorFileBuffer.size();
-      }
-      mFileReadIndex.store(readIdx);
-      gotInput = true;
+  // Modulador novo cargado ou gravado pola UI
+  if (mModulatorFile.acquire()) {
+    const SampleBuffer &file = mModulatorFile.front();
+    audio.fileStretcher.setSource(file.data(), file.size());
+  }
+  // Carrier externo novo: o id publícase antes que o buffer
+  if (mCarrierFile.acquire()) {
+    const SampleBuffer &carrier = mCarrierFile.front();
+    audio.carrierReader.setSource(carrier.data(), carrier.size());
+    audio.carrierId = controls.carrierId.load(std::memory_order_relaxed);
+    for (LayerAudioState &layer : audio.layers) {
+      layer.carrierReader.setSource(carrier.data(), carrier.size());
     }
   }
 
-  // Comprobar se temos carrier externo (tipo 4)
-  if (mWaveformType.load() == 4 && !mCarrierFileBuffer.empty()) {
-    int32_t readIdx = mCarrierReadIndex.load();
-    for (int i = 0; i < numFrames; i++) {
-      mCarrierWorkBuffer[i] = mCarrierFileBuffer[readIdx];
-      readIdx = (readIdx + 1) % (int32_t)mCarrierFileBuffer.size();
+  if (source == 1) { // SOURCE_FILE
+    if (controls.fileResetPending.exchange(false)) {
+      audio.fileStretcher.reset();
+    }
+    if (!audio.fileStretcher.isEmpty() &&
+        controls.isFilePlaying.load(std::memory_order_relaxed)) {
+      // Time-stretch WSOLA: custo constante por callback
+      audio.fileStretcher.setSpeed(
+          controls.fileSpeed.load(std::memory_order_relaxed));
+      audio.fileStretcher.render(inputBuffer, numFrames);
+      meters.fileStretchLoad.store(audio.fileStretcher.getCpuLoad(),
+                                   std::memory_order_relaxed);
+      gotInput = true;
     }
-    mCarrierReadIndex.store(readIdx);
+  }
+
+  // Comprobar se temos carrier externo (tipo 4). O procesador léeo
+  // seguindo o pitch e o vibrato.
+  if (controls.waveformType.load(std::memory_order_relaxed) == 4 &&
+      !audio.carrierReader.isEmpty()) {
     hasExtCarrier = true;
   }
 
   if (!gotInput) {
-    std::fill(mInputBuffer.begin(), mInputBuffer.begin() + numFrames, 0.0f);
+    std::fill(inputBuffer, inputBuffer + numFrames, 0.0f);
   }
 
   // Calcular VU Level (RMS con balística y escalado)
-  // Usar mInputBuffer si hay entrada activa, o currentMicData si estamos
-  // grabando
+  // Usar inputBuffer si hay entrada activa, o micBuffer si estamos grabando
   float sumSq = 0.0f;
-  const float *vuSource =
-      gotInput ? mInputBuffer.data() : mMicWorkBuffer.data();
+  const float *vuSource = gotInput ? inputBuffer : micBuffer;
   for (int i = 0; i < numFrames; i++) {
     float val = vuSource[i];
     sumSq += val * val;
@@ -193,33 +396,90 @@ oboe::DataCallbackResult VocoderEngine::onAudioReady(oboe::AudioStream *stream,
   float targetVU = std::pow(rms * 1.8f, 0.6f);
 
   // Ballistics: Ataque rápido, liberación más lenta
-  float currentVU = mVULevel.load();
+  float currentVU = meters.vuLevel.load(std::memory_order_relaxed);
   float factor = (targetVU > currentVU) ? 0.25f : 0.08f;
   float nextVU = currentVU + (targetVU - currentVU) * factor;
 
-  mVULevel = std::clamp(nextVU, 0.0f, 1.2f);
+  meters.vuLevel.store(std::clamp(nextVU, 0.0f, 1.2f),
+                       std::memory_order_relaxed);
+
+  if (capturing) {
+    session::SessionBlock block{};
+    block.frame = audio.captureFrame;
+    block.numFrames = static_cast<uint32_t>(numFrames);
+    block.flags = hasExtCarrier ? session::kBlockExtCarrier : 0;
+    block.carrierId = audio.carrierId;
+    block.carrierPosition = audio.carrierReader.getPosition();
+    mRecorder->writeBlock(block, inputBuffer);
+    audio.captureFrame += numFrames;
+  }
 
   // Procesar vocoder
-  mProcessor->process(mInputBuffer.data(),
-                      hasExtCarrier ? mCarrierWorkBuffer.data() : nullptr,
-                      outputData, numFrames);
-
-  // Copiar datos para visualización
-  int displaySamples = std::min(numFrames, 256);
-  std::copy(outputData, outputData + displaySamples, mWaveformBuffer.begin());
+  SampleReader *extCarrier = hasExtCarrier ? &audio.carrierReader : nullptr;
+  // Con capas, a principal e as capas saen sen saturar e o tanh aplícase
+  // á suma: cada capa saturada por separado daría ata ±kMaxLayers
+  audio.processor.setSoftClip(!layered);
+  if (!layered) {
+    audio.processor.process(inputBuffer, extCarrier, outputData, numFrames);
+  } else {
+    // Por bloques: cada capa reutiliza as envolventes de banda que a
+    // principal acaba de calcular para o mesmo bloque
+    constexpr int kBlock = VocoderProcessor::kMaxBlockFrames;
+    float *layerOutput = audio.layerOutput.data();
+    for (int offset = 0; offset < numFrames; offset += kBlock) {
+      int frames = std::min(kBlock, numFrames - offset);
+      const float *input = inputBuffer + offset;
+      float *output = outputData + offset * kOutputChannelCount;
+      audio.processor.process(input, extCarrier, output, frames);
+      for (LayerAudioState &layer : audio.layers) {
+        if (!layer.active)
+          continue;
+        SampleReader *layerCarrier =
+            layer.extCarrier && !layer.carrierReader.isEmpty()
+                ? &layer.carrierReader
+                : nullptr;
+        layer.processor.processLayer(audio.processor, input, layerCarrier,
+                                     layerOutput, frames);
+        for (int i = 0; i < frames * kOutputChannelCount; i++) {
+          output[i] += layerOutput[i];
+        }
+      }
+      for (int i = 0; i < frames * kOutputChannelCount; i++) {
+        output[i] = std::tanh(output[i]);
+      }
+    }
+  }
 
-  return oboe::DataCallbackResult::Continue;
+  // Copiar datos para visualización (canle esquerda)
+  int displaySamples = std::min<int>(numFrames, EngineMeters::kWaveformSize);
+  for (int i = 0; i < displaySamples; i++) {
+    meters.waveform[i] = outputData[i * kOutputChannelCount];
+  }
+  meters.bands.publish(audio.processor.getBandEnvelopes().data(),
+                       audio.processor.getBandGainReduction().data());
+  meters.pitchFrequency.store(audio.processor.getDetectedPitch(),
+                              std::memory_order_relaxed);
+  meters.pitchConfidence.store(audio.processor.getPitchConfidence(),
+                               std::memory_order_relaxed);
+  meters.pitchLatencyMs.store(audio.processor.getPitchTrackerLatencyMs(),
+                              std::memory_order_relaxed);
+  meters.pitchLoad.store(audio.processor.getPitchTrackerLoad(),
+                         std::memory_order_relaxed);
 }
 
 void VocoderEngine::startRecording() {
   std::lock_guard<std::mutex> lock(mRecordingMutex);
   mRecordedData.clear();
-  mIsRecording = true;
+  // Capacidade fixa reservada aquí: o callback nunca realoca
+  mRecordedData.reserve(static_cast<size_t>(kSampleRate) *
+                        kMaxRecordingSeconds);
+  mState->controls.recordingFull.store(false);
+  mState->controls.isRecording.store(true);
   LOGI("Internal recording started");
 }
 
 void VocoderEngine::stopRecording() {
-  mIsRecording = false;
+  mState->controls.isRecording.store(false);
   std::lock_guard<std::mutex> lock(mRecordingMutex);
 
   if (!mRecordedData.empty()) {
@@ -239,68 +499,256 @@ void VocoderEngine::stopRecording() {
     }
     */
 
-    mModulatorFileBuffer = mRecordedData;
-    mFileReadIndex = 0;
-    LOGI("Internal recording stopped. Captured %d samples",
-         (int)mModulatorFileBuffer.size());
+    mModulatorFile.back() = mRecordedData;
+    mModulatorFile.publish();
+    LOGI("Internal recording stopped. Captured %d samples%s",
+         mModulatorFile.latest().size(),
+         mState->controls.recordingFull.load() ? " (length limit reached)"
+                                               : "");
   }
+  // A capacidade de gravación só se mantén mentres se grava
+  mRecordedData.release();
 }
 
 void VocoderEngine::setModulatorBuffer(const float *data, int32_t numSamples) {
-  mModulatorFileBuffer.assign(data, data + numSamples);
-  mFileReadIndex.store(0);
-  LOGI("Loaded %d samples into modulator buffer", numSamples);
+  mModulatorFile.back().assign(data, numSamples);
+  mModulatorFile.publish();
+  LOGI("Loaded %d samples into modulator buffer (sample memory: %zu bytes)",
+       numSamples, getSampleMemoryBytes());
 }
 
 void VocoderEngine::setSource(int source) {
-  mSource.store(source);
+  mState->controls.source.store(source);
   LOGI("Switching source to: %s", source == 0 ? "Microphone" : "File");
 }
 
 void VocoderEngine::setFilePlaying(bool playing) {
-  mIsFilePlaying.store(playing);
+  mState->controls.isFilePlaying.store(playing);
 }
 
 void VocoderEngine::setMicActive(bool active) {
-  mIsMicActive.store(active);
+  mState->controls.isMicActive.store(active);
   LOGI("Mic active: %s", active ? "true" : "false");
 }
 
-void VocoderEngine::resetFileIndex() { mFileReadIndex.store(0); }
+void VocoderEngine::resetFileIndex() {
+  mState->controls.fileResetPending.store(true);
+}
+
+void VocoderEngine::setFileSpeed(float speed) {
+  mState->controls.fileSpeed.store(speed);
+}
 
 // Setters
-void VocoderEngine::setPitch(float pitch) { mProcessor->setPitch(pitch); }
+void VocoderEngine::setPitch(float pitch) {
+  postParam({ParamId::Pitch, 0, 0, 0, pitch});
+}
 
 void VocoderEngine::setIntensity(float intensity) {
-  mProcessor->setIntensity(intensity);
+  postParam({ParamId::Intensity, 0, 0, 0, intensity});
 }
 
 void VocoderEngine::setWaveform(int type) {
-  mWaveformType.store(type);
+  mState->controls.waveformType.store(type);
   if (type < 4) {
-    mProcessor->setWaveform(type);
+    postParam({ParamId::Waveform, 0, static_cast<int8_t>(type), 0, 0.0f});
   }
 }
 
 void VocoderEngine::setCarrierBuffer(const float *data, int32_t numSamples) {
-  mCarrierFileBuffer.assign(data, data + numSamples);
-  mCarrierReadIndex.store(0);
-  LOGI("External carrier loaded: %d samples", numSamples);
+  SampleBuffer &carrier = mCarrierFile.back();
+  carrier.assign(data, numSamples);
+  uint32_t id = mState->controls.carrierId.load() + 1;
+  mRecorder->writeCarrier(id, carrier.data(), numSamples);
+  mState->controls.carrierId.store(id);
+  mCarrierFile.publish();
+  LOGI("External carrier loaded: %d samples (sample memory: %zu bytes)",
+       numSamples, getSampleMemoryBytes());
 }
 
-void VocoderEngine::setVibrato(float amount) { mProcessor->setVibrato(amount); }
+void VocoderEngine::setVibrato(float amount) {
+  postParam({ParamId::Vibrato, 0, 0, 0, amount});
+}
 
-void VocoderEngine::setEcho(float amount) { mProcessor->setEcho(amount); }
+void VocoderEngine::setEcho(float amount) {
+  postParam({ParamId::Echo, 0, 0, 0, amount});
+}
 
-void VocoderEngine::setTremolo(float amount) { mProcessor->setTremolo(amount); }
+void VocoderEngine::setTremolo(float amount) {
+  postParam({ParamId::Tremolo, 0, 0, 0, amount});
+}
 
 void VocoderEngine::setNoiseThreshold(float threshold) {
-  mProcessor->setNoiseThreshold(threshold);
+  postParam({ParamId::NoiseThreshold, 0, 0, 0, threshold});
+}
+
+void VocoderEngine::setFormant(float semitones) {
+  postParam({ParamId::Formant, 0, 0, 0, semitones});
+}
+
+void VocoderEngine::setStereo(bool enabled) {
+  postParam({ParamId::Stereo, 0, enabled, 0, 0.0f});
+  LOGI("Stereo: %s", enabled ? "true" : "false");
+}
+
+void VocoderEngine::setStereoWidth(float width) {
+  postParam({ParamId::StereoWidth, 0, 0, 0, width});
+}
+
+void VocoderEngine::setEngine(int engine) {
+  postParam({ParamId::Engine, 0, static_cast<int8_t>(engine), 0, 0.0f});
+  LOGI("Vocoder engine: %s", engine == 1 ? "LPC" : "Filter bank");
+}
+
+void VocoderEngine::setAdditive(bool enabled) {
+  postParam({ParamId::Additive, 0, enabled, 0, 0.0f});
+  LOGI("Additive carrier: %s", enabled ? "true" : "false");
+}
+
+void VocoderEngine::setAdditiveTilt(float tilt) {
+  postParam({ParamId::AdditiveTilt, 0, 0, 0, tilt});
+}
+
+void VocoderEngine::setModSlot(int slot, int source, int destination,
+                               float depth) {
+  if (!isValidParamChange(ParamId::ModSlot, slot, source, destination))
+    return;
+  postParam({ParamId::ModSlot, static_cast<uint8_t>(slot),
+             static_cast<int8_t>(source), static_cast<int8_t>(destination),
+             depth});
+}
+
+void VocoderEngine::setModLfo(int index, float rateHz, int shape) {
+  if (!isValidParamChange(ParamId::ModLfo, index, shape, 0))
+    return;
+  postParam({ParamId::ModLfo, static_cast<uint8_t>(index),
+             static_cast<int8_t>(shape), 0, rateHz});
+}
+
+void VocoderEngine::setPitchFollow(bool enabled) {
+  postParam({ParamId::PitchFollow, 0, enabled, 0, 0.0f});
+  LOGI("Pitch follow: %s", enabled ? "true" : "false");
+}
+
+void VocoderEngine::setPitchInterval(float semitones) {
+  postParam({ParamId::PitchInterval, 0, 0, 0, semitones});
+}
+
+void VocoderEngine::setPitchScale(int scale) {
+  postParam({ParamId::PitchScale, 0, static_cast<int8_t>(scale), 0, 0.0f});
+}
+
+void VocoderEngine::postParam(const ParamChange &change) {
+  mState->controls.params.post(change);
+}
+
+int VocoderEngine::createLayer() {
+  EngineControls &controls = mState->controls;
+  for (int i = 0; i < kMaxLayers - 1; i++) {
+    EngineControls::Layer &layer = controls.layers[i];
+    if (layer.active.load())
+      continue;
+    // A capa parte dos parámetros actuais da principal; a nova xeración
+    // fai que o callback reinicie o procesador antes de aplicalos, e
+    // activala despois de publicalos fai que os aplique no primeiro bloque
+    controls.params.forEachSet(
+        [&](const ParamChange &change) { layer.params.post(change); });
+    layer.generation.fetch_add(1, std::memory_order_relaxed);
+    layer.active.store(true, std::memory_order_release);
+    LOGI("Layer %d created", i + 1);
+    return i + 1;
+  }
+  LOGE("No free layers (max %d)", kMaxLayers - 1);
+  return -1;
+}
+
+bool VocoderEngine::setKernelVariant(int variant) {
+  KernelVariant selected = detectKernelVariant();
+  if (variant >= 0) {
+    if (variant >= static_cast<int>(KernelVariant::Count) ||
+        !isKernelVariantSupported(static_cast<KernelVariant>(variant))) {
+      LOGE("Kernel variant %d not supported on this CPU", variant);
+      return false;
+    }
+    selected = static_cast<KernelVariant>(variant);
+  }
+  mState->controls.kernelVariant.store(static_cast<int>(selected));
+  LOGI("DSP kernels: %s%s", kernelVariantName(selected),
+       variant < 0 ? " (auto)" : "");
+  return true;
+}
+
+int VocoderEngine::getKernelVariant() const {
+  return mState->controls.kernelVariant.load();
+}
+
+void VocoderEngine::destroyLayer(int handle) {
+  if (handle < 1 || handle >= kMaxLayers)
+    return;
+  mState->controls.layers[handle - 1].active.store(false,
+                                                   std::memory_order_release);
+  LOGI("Layer %d destroyed", handle);
 }
 
+void VocoderEngine::postLayerParam(int handle, const ParamChange &change) {
+  if (handle == 0 && change.id == ParamId::Waveform) {
+    setWaveform(change.a); // O carrier externo da principal non é un param
+  } else if (handle == 0) {
+    postParam(change);
+  } else if (handle > 0 && handle < kMaxLayers) {
+    mState->controls.layers[handle - 1].params.post(change);
+  }
+}
+
+bool VocoderEngine::startCapture(const char *path) {
+  if (!mRecorder->start(path, kSampleRate, VocoderProcessor::kNumBands,
+                        VocoderProcessor::getFilterName()))
+    return false;
+  const SampleBuffer &carrier = mCarrierFile.latest();
+  if (!carrier.empty()) {
+    mRecorder->writeCarrier(mState->controls.carrierId.load(), carrier.data(),
+                            carrier.size());
+  }
+  return true;
+}
+
+bool VocoderEngine::stopCapture() { return mRecorder->stop(); }
+
 // Getters
-float VocoderEngine::getVULevel() const { return mVULevel.load(); }
+float VocoderEngine::getVULevel() const {
+  return mState->meters.vuLevel.load();
+}
+
+size_t VocoderEngine::getSampleMemoryBytes() const {
+  size_t recordingBytes;
+  {
+    std::lock_guard<std::mutex> lock(mRecordingMutex);
+    recordingBytes = mRecordedData.memoryBytes();
+  }
+  return mModulatorFile.memoryBytes() + mCarrierFile.memoryBytes() +
+         recordingBytes;
+}
 
 std::vector<float> VocoderEngine::getWaveformData() const {
-  return mWaveformBuffer;
+  const auto &waveform = mState->meters.waveform;
+  return std::vector<float>(waveform.begin(), waveform.end());
+}
+
+int VocoderEngine::getBandLevels(float *envelope, float *reduction) const {
+  if (!mState->meters.bands.read(envelope, reduction))
+    return 0;
+  return BandMeterSnapshot::kNumBands;
+}
+
+std::vector<float> VocoderEngine::getPitchInfo() const {
+  const EngineMeters &meters = mState->meters;
+  return {meters.pitchFrequency.load(std::memory_order_relaxed),
+          meters.pitchConfidence.load(std::memory_order_relaxed),
+          meters.pitchLatencyMs.load(std::memory_order_relaxed),
+          meters.pitchLoad.load(std::memory_order_relaxed)};
+}
+
+std::vector<float> VocoderEngine::getStartInfo() const {
+  return {mColdStartMs.load(), mWarmStartMs.load(),
+          static_cast<float>(mReopenCount.load())};
 }
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "DSPComponents.h"
+#include "EngineState.h"
+#include "SampleBuffer.h"
+#include "SessionRecorder.h"
 #include "VocoderProcessor.h"
 #include <atomic>
 #include <memory>
@@ -11,20 +14,34 @@
 /**
  * Motor de audio principal basado en Oboe.
  * Gestiona el ciclo de vida de los streams y el callback de procesamiento.
+ *
+ * Os streams quedan abertos en standby tras stop(), de xeito que o
+ * seguinte start() só ten que arrancalos (warm start). Se o sistema pecha
+ * un stream (desconexión de auriculares, cambio de ruta) reábrense
+ * automaticamente sen tocar o estado do procesador. Os streams exclusivos
+ * en standby reservan o micro e a saída de baixa latencia: release()
+ * péchaos cando a app pasa a segundo plano e prepare() volve abrilos.
  */
-class VocoderEngine : public oboe::AudioStreamDataCallback {
+class VocoderEngine : public oboe::AudioStreamDataCallback,
+                      public oboe::AudioStreamErrorCallback {
 public:
   VocoderEngine();
   ~VocoderEngine();
 
+  bool prepare(); // Abre os streams en standby sen arrancalos
   bool start();
   void stop();
+  void release(); // Pecha os streams en standby (non se está a soar)
 
   // Implementación de oboe::AudioStreamDataCallback
   oboe::DataCallbackResult onAudioReady(oboe::AudioStream *stream,
                                         void *audioData,
                                         int32_t numFrames) override;
 
+  // Implementación de oboe::AudioStreamErrorCallback
+  void onErrorAfterClose(oboe::AudioStream *stream,
+                         oboe::Result error) override;
+
   // Parámetros
   void setPitch(float pitch);
   void setIntensity(float intensity);
@@ -33,6 +50,17 @@ public:
   void setEcho(float amount);
   void setTremolo(float amount);
   void setNoiseThreshold(float threshold);
+  void setFormant(float semitones);
+  void setStereo(bool enabled);
+  void setStereoWidth(float width);
+  void setEngine(int engine); // 0 = Banco de filtros, 1 = LPC
+  void setAdditive(bool enabled);
+  void setAdditiveTilt(float tilt);
+  void setModSlot(int slot, int source, int destination, float depth);
+  void setModLfo(int index, float rateHz, int shape);
+  void setPitchFollow(bool enabled);
+  void setPitchInterval(float semitones);
+  void setPitchScale(int scale);
 
   // Soporte de archivo / Modulador Interno
   void setMicActive(bool active);
@@ -40,55 +68,97 @@ public:
   void setSource(int source); // 0 = Mic, 1 = File
   void setFilePlaying(bool playing);
   void resetFileIndex();
+  void setFileSpeed(float speed); // 0.25x - 2x, sen cambiar o ton
   void setCarrierBuffer(const float *data, int32_t numSamples);
 
   // Grabación Interna
   void startRecording();
   void stopRecording();
-  bool isRecording() const { return mIsRecording; }
+  bool isRecording() const { return mState->controls.isRecording.load(); }
+  // true se a gravación se detivo soa ao encher kMaxRecordingSeconds; a UI
+  // debe chamar igualmente a stopRecording() para cargala
+  bool isRecordingFull() const {
+    return mState->controls.recordingFull.load(std::memory_order_acquire);
+  }
+
+  // Captura de sesión (modulador, carrier e parámetros) para replay no host
+  bool startCapture(const char *path);
+  bool stopCapture(); // false se a sesión quedou incompleta
+
+  // Capas: procesadores extra sobre o mesmo modulador e os mesmos streams,
+  // mesturados na saída. createLayer devolve un handle (1..kMaxLayers-1)
+  // ou -1; o handle 0 é a capa principal dos setters de arriba
+  int createLayer();
+  void destroyLayer(int handle);
+  void postLayerParam(int handle, const ParamChange &change);
+
+  // Kernels DSP: -1 = a mellor variante para esta CPU (por defecto), ou
+  // unha KernelVariant concreta para probas. false se a CPU non a admite
+  bool setKernelVariant(int variant);
+  int getKernelVariant() const;
 
   // Getters
   float getVULevel() const;
+  size_t getSampleMemoryBytes() const;
   std::vector<float> getWaveformData() const;
+  // Envolvente e redución de ganancia por banda (kNumBands valores en
+  // cada táboa). Devolve o número de bandas, ou 0 sen lectura coherente
+  int getBandLevels(float *envelope, float *reduction) const;
+  // [f0 Hz, confianza, latencia ms, carga CPU do detector]
+  std::vector<float> getPitchInfo() const;
+  float getFileStretchLoad() const {
+    return mState->meters.fileStretchLoad.load(std::memory_order_relaxed);
+  }
+  // [ms último arranque en frío, ms último arranque en quente, reaperturas]
+  std::vector<float> getStartInfo() const;
 
 private:
   void createStreams();
+  bool openStreams();
+  bool startStreams();
+  void pauseStreams();
   void closeStreams();
+  static void closeStream(std::shared_ptr<oboe::AudioStream> &stream);
+
+  void renderChunk(float *outputData, int32_t numFrames);
+  void postParam(const ParamChange &change);
 
   std::shared_ptr<oboe::AudioStream> mInputStream;
   std::shared_ptr<oboe::AudioStream> mOutputStream;
-  std::unique_ptr<VocoderProcessor> mProcessor;
 
-  std::vector<float> mInputBuffer;
-  std::vector<float> mOutputBuffer;
-  std::vector<float> mWaveformBuffer;
+  // Estado en tempo real (procesador, buffers de traballo, controis e
+  // medidores) nun único bloque aliñado a liña de caché
+  std::unique_ptr<EngineState> mState;
 
-  // Buffers de traballo pre-alocados (evitan asignacións no callback)
-  std::vector<float> mCarrierWorkBuffer;
-  std::vector<float> mMicWorkBuffer;
+  std::unique_ptr<SessionRecorder> mRecorder;
 
-  // Buffer para archivo / Modulador grabado
-  std::vector<float> mModulatorFileBuffer;
-  std::atomic<int32_t> mFileReadIndex{0};
+  // Buffer para archivo / Modulador grabado. A UI publica e o callback
+  // cámbiao no TimeStretcher ao comezo dun bloque
+  SampleBufferHandoff mModulatorFile;
 
-  // Buffer para Carrier externo
-  std::vector<float> mCarrierFileBuffer;
-  std::atomic<int32_t> mCarrierReadIndex{0};
+  // Buffer para Carrier externo (lido a velocidade variable), co mesmo
+  // intercambio no callback
+  SampleBufferHandoff mCarrierFile;
 
-  std::atomic<int> mSource{0}; // 0 = Mic, 1 = File
-  std::atomic<int> mWaveformType{0};
-  std::atomic<bool> mIsFilePlaying{false};
-  std::atomic<bool> mIsMicActive{false};
+  // Estado de grabación interna (capacidade fixa: non realoca no callback)
+  SampleBuffer mRecordedData;
+  mutable std::mutex mRecordingMutex;
+  static constexpr int kMaxRecordingSeconds = 60;
 
-  // Estado de grabación interna
-  bool mIsRecording = false;
-  std::vector<float> mRecordedData;
-  std::mutex mRecordingMutex;
+  std::atomic<bool> mIsRunning{false};
 
-  std::atomic<float> mVULevel{0.0f};
-  bool mIsRunning = false;
+  // Ciclo de vida dos streams (UI e fío de erros de Oboe)
+  std::mutex mLifecycleMutex;
+  // Peche do motor: o fío de erros non reabre nada e o destrutor agarda
+  // polos erros que xa estaban en curso
+  std::atomic<bool> mShuttingDown{false};
+  std::atomic<int> mErrorCallbacksActive{0};
+  std::atomic<float> mColdStartMs{0.0f};
+  std::atomic<float> mWarmStartMs{0.0f};
+  std::atomic<int> mReopenCount{0};
 
   static constexpr int kSampleRate = 48000;
-  static constexpr int kChannelCount = 1;
+  static constexpr int kInputChannelCount = 1;
+  static constexpr int kOutputChannelCount = VocoderProcessor::kOutputChannels;
   static constexpr int kFramesPerBuffer = 256;
 };
@@ -0,0 +1,16 @@
+# Opcións de compilación do núcleo DSP. Inclúena a app e as ferramentas de
+# host (session_replay, dsp_bench), para que estas comproben e midan o mesmo
+# código que se distribúe
+set(VOCODER_DSP_OPTIONS
+    -O3
+    -ffast-math
+    -funroll-loops
+)
+
+# x86: as variantes dos kernels (CpuFeatures.h) teñen que dar a mesma saída
+# bit a bit, así que nin contraccións a FMA nin sumas reasociadas, que
+# cambiarían co ancho dos vectores. O resto de -ffast-math mantense
+set(VOCODER_DSP_OPTIONS_X86
+    -ffp-contract=off
+    -fno-associative-math
+)
@@ -9,13 +9,38 @@ static constexpr float kThresholdHysteresis =
     0.4f; // Ajustado (era 0.6) para reducir salto de volumen (clic)
 static constexpr float kOutputNormalization = 0.55f; // Normalización standard
 static constexpr float kVibratoDepthHz = 20.0f; // Profundidad del vibrato en Hz
+static constexpr float kCarrierReferencePitch =
+    140.0f; // Pitch ao que o carrier externo soa á súa velocidade orixinal
+static constexpr float kMinPitchConfidence =
+    0.6f; // Por debaixo, mantense o último pitch seguido
+static constexpr float kBandQ =
+    12.0f; // Restaurado a 12.0 para buena separación y definición
+static constexpr float kLpcOutputGain =
+    0.03f; // Iguala o nivel do motor LPC co do banco de filtros
 
-constexpr std::array<float, VocoderProcessor::kNumBands>
-    VocoderProcessor::kBandFrequencies;
+// Rango de cada destino da matriz de modulación (para modulación = ±1)
+static constexpr float kModPitchOctaves = 1.0f;
+static constexpr float kModIntensityRange = 2.0f;
+static constexpr float kModEchoRange = 0.7f;
+static constexpr float kModThresholdOctaves = 2.0f;
+static constexpr float kModFormantSemitones = 12.0f;
+static constexpr float kFormantUpdateSemitones =
+    0.05f; // Cambio mínimo para recalcular os filtros do carrier
 
-VocoderProcessor::VocoderProcessor(float sampleRate)
+// Escalas para a cuantización do pitch seguido (bit n = semitón n sobre Do)
+static constexpr std::array<int, 5> kScaleMasks = {
+    0x000, // Libre (sen cuantizar)
+    0xFFF, // Cromática
+    0xAB5, // Maior
+    0x5AD, // Menor natural
+    0x295, // Pentatónica maior
+};
+
+template <typename BandBank>
+VocoderProcessorT<BandBank>::VocoderProcessorT(float sampleRate)
     : mSampleRate(sampleRate), mCarrier(sampleRate), mVibratoLFO(sampleRate),
-      mTremoloLFO(sampleRate) {
+      mTremoloLFO(sampleRate), mPitchTracker(sampleRate),
+      mModMatrix(sampleRate), mLpc(sampleRate), mAdditive(sampleRate) {
 
   // Configurar constantes de tiempo para los suavizadores (~30ms)
   float tc = 30.0f;
@@ -26,12 +51,8 @@ VocoderProcessor::VocoderProcessor(float sampleRate)
   sTremoloAmount.setTimeConstant(tc, sampleRate);
   sBasePitch.setTimeConstant(tc, sampleRate);
 
-  // Valores iniciales
-  sNoiseThreshold.setTarget(0.003f); // Umbral bajo para evitar cortes
-  sIntensity.setTarget(0.8f);        // Ganancia standard
-  sBasePitch.setTarget(140.0f);
-
   mEchoBuffer.resize(kEchoSamples, 0.0f);
+  mEchoBufferRight.resize(kEchoSamples, 0.0f);
 
   // Vibrato LFO: 5Hz Sine
   mVibratoLFO.setFrequency(5.0f);
@@ -45,120 +66,642 @@ VocoderProcessor::VocoderProcessor(float sampleRate)
   mModHPF.setCoefficients(200.0f, 0.707f, sampleRate);
 
   initBands();
+  reset();
 }
 
-void VocoderProcessor::initBands() {
-  constexpr float Q =
-      12.0f; // Restaurado a 12.0 para buena separación y definición
+template <typename BandBank> void VocoderProcessorT<BandBank>::reset() {
+  // Valores iniciales
+  sIntensity.reset(0.0f);
+  sNoiseThreshold.reset(0.0f);
+  sEchoAmount.reset(0.0f);
+  sVibratoAmount.reset(0.0f);
+  sTremoloAmount.reset(0.0f);
+  sBasePitch.reset(0.0f);
+  sNoiseThreshold.setTarget(0.003f); // Umbral bajo para evitar cortes
+  sIntensity.setTarget(0.8f);        // Ganancia standard
+  sBasePitch.setTarget(140.0f);
+
+  mCarrier.reset();
+  mCarrier.setWaveform(Oscillator::Waveform::Sawtooth);
+  mVibratoLFO.reset();
+  mTremoloLFO.reset();
+
+  mPitchTracker.reset();
+  mPitchFollow = false;
+  mPitchInterval = 0.0f;
+  mPitchScale = 0;
+  mManualPitch = 140.0f;
+
+  mModMatrix.reset();
+  mFormantShift = 0.0f;
+  mFormantChanged = false;
+  updateFormant(0.0f, true);
+
+  mLpc.reset();
+  mEngine = 0;
+  mAppliedEngine = 0;
+
+  mAdditive.setTilt(1.0f);
+  mAdditive.reset();
+  mAdditiveMode = false;
+  mAppliedAdditive = false;
+
+  mModHPF.reset();
+  resetBands();
+  mEnvelopeFrames = 0;
+
+  mStereo = false;
+  mAppliedStereo = false;
+  mStereoWidth = 0.7f;
+  mAppliedWidth = -1.0f;
+  mPanRamping = false;
+  mMeterEnvelope.fill(0.0f);
+  mMeterReduction.fill(0.0f);
+
+  std::fill(mEchoBuffer.begin(), mEchoBuffer.end(), 0.0f);
+  std::fill(mEchoBufferRight.begin(), mEchoBufferRight.end(), 0.0f);
+  mEchoIndex = 0;
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::initBands() {
   for (int i = 0; i < kNumBands; i++) {
     mBands[i].frequency = kBandFrequencies[i];
-    mBands[i].modFilter.setCoefficients(kBandFrequencies[i], Q, mSampleRate);
-    mBands[i].carFilter.setCoefficients(kBandFrequencies[i], Q, mSampleRate);
+    mCarrierFreqs[i] = kBandFrequencies[i];
+    mModBank.setBand(i, kBandFrequencies[i], kBandQ, mSampleRate);
+    mCarBank.setBand(i, kBandFrequencies[i], kBandQ, mSampleRate);
     mBands[i].envelope = EnvelopeFollower(mSampleRate);
   }
 }
 
-void VocoderProcessor::process(const float *input, const float *extCarrier,
-                               float *output, int numFrames) {
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::resetBands() {
+  mModBank.reset();
+  mCarBank.reset();
+  for (Band &band : mBands)
+    band.envelope.reset();
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::updateFormant(float semitones, bool force) {
+  // A histérese só filtra a modulación: un cambio do usuario sempre aplica
+  if (!force &&
+      std::abs(semitones - mAppliedFormant) < kFormantUpdateSemitones)
+    return;
+  mAppliedFormant = semitones;
+
+  // Desprazar só os filtros do carrier: as envolventes do modulador
+  // aplícanse sobre bandas máis altas ou máis baixas
+  float ratio = std::exp2(semitones / 12.0f);
+  float maxFreq = mSampleRate * 0.45f;
+  for (int i = 0; i < kNumBands; i++) {
+    float freq = std::min(mBands[i].frequency * ratio, maxFreq);
+    mCarrierFreqs[i] = freq;
+    mCarBank.setBand(i, freq, kBandQ, mSampleRate);
+  }
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::updatePanning(int numFrames) {
+  const bool first = mAppliedWidth < 0.0f;
+  mAppliedWidth = mStereoWidth;
+
+  // Bandas alternadas a esquerda e dereita, lei de potencia constante.
+  // Escalado por sqrt(2) para que o centro soe igual que en mono.
+  for (int i = 0; i < kNumBands; i++) {
+    float pan = (i % 2 == 0 ? -1.0f : 1.0f) * mStereoWidth;
+    float angle = (pan + 1.0f) * static_cast<float>(M_PI) * 0.25f;
+    mPanLeftTarget[i] = static_cast<float>(M_SQRT2) * std::cos(angle);
+    mPanRightTarget[i] = static_cast<float>(M_SQRT2) * std::sin(angle);
+  }
+
+  if (first) {
+    mPanLeft = mPanLeftTarget;
+    mPanRight = mPanRightTarget;
+    return;
+  }
+  // Rampa lineal ata as novas ganancias ao longo do bloque: sen clics
+  // aínda que o ancho salte dun bloque ao seguinte
+  float invN = 1.0f / numFrames;
+  for (int i = 0; i < kNumBands; i++) {
+    mPanLeftStep[i] = (mPanLeftTarget[i] - mPanLeft[i]) * invN;
+    mPanRightStep[i] = (mPanRightTarget[i] - mPanRight[i]) * invN;
+  }
+  mPanRamping = true;
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::process(const float *input,
+                                          SampleReader *extCarrier,
+                                          float *output, int numFrames) {
+  trackPitch(input, numFrames);
+
+  for (int offset = 0; offset < numFrames; offset += kMaxBlockFrames) {
+    int blockFrames = std::min(kMaxBlockFrames, numFrames - offset);
+    processBlock(input + offset, extCarrier,
+                 output + offset * kOutputChannels, blockFrames, nullptr);
+  }
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::processLayer(const VocoderProcessorT &leader,
+                                               const float *input,
+                                               SampleReader *extCarrier,
+                                               float *output, int numFrames) {
+  trackPitch(input, numFrames);
+
+  // Só se o líder analizou este mesmo bloque co banco de filtros
+  const float *shared = nullptr;
+  if (leader.mEnvelopeFrames == numFrames) {
+    shared = leader.mEnvelopeWork.data();
+  }
+  processBlock(input, extCarrier, output, numFrames, shared);
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setSoftClip(bool enabled) {
+  mSoftClip = enabled;
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::trackPitch(const float *input,
+                                             int numFrames) {
+  // Seguimento de pitch: a última análise completa do bloque
+  if (mPitchFollow && mPitchTracker.process(input, numFrames) &&
+      mPitchTracker.getConfidence() >= kMinPitchConfidence) {
+    // Rango en vez de isfinite, que -ffast-math pode eliminar: un f0
+    // negativo, nulo ou infinito deixaría sBasePitch en NaN para sempre
+    float detected = mPitchTracker.getFrequency();
+    if (detected >= PitchTracker::kMinF0 * 0.5f &&
+        detected <= PitchTracker::kMaxF0 * 2.0f) {
+      sBasePitch.setTarget(followPitch(detected));
+    }
+  }
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setKernelVariant(KernelVariant variant) {
+  mKernelVariant =
+      isKernelVariantSupported(variant) ? variant : KernelVariant::Generic;
+}
+
+template <typename BandBank>
+VOCODER_ALWAYS_INLINE void
+VocoderProcessorT<BandBank>::analyseModulator(const float *input,
+                                              int numFrames) {
+  for (int frame = 0; frame < numFrames; frame++) {
+    // Preamplificación e HPF para quitar o retumbo de graves que causa
+    // acople
+    float modSample = mModHPF.process(input[frame] * kModulatorPreamp);
+
+    // Filtrar o modulador en todas as bandas e seguir as envolventes
+    mModBank.process(modSample, mModOut.data());
+    float *envelopes = mEnvelopeWork.data() + frame * kNumBands;
+    for (int i = 0; i < kNumBands; i++) {
+      envelopes[i] = mBands[i].envelope.process(mModOut[i]);
+    }
+  }
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::processBlock(const float *input,
+                                               SampleReader *extCarrier,
+                                               float *output, int numFrames,
+                                               const float *sharedEnvelopes) {
+  switch (mKernelVariant) {
+#if VOCODER_KERNELS_AVX2
+  case KernelVariant::Avx2:
+    processBlockAvx2(input, extCarrier, output, numFrames, sharedEnvelopes);
+    break;
+#endif
+  default:
+    processBlockImpl(input, extCarrier, output, numFrames, sharedEnvelopes);
+    break;
+  }
+}
+
+#if VOCODER_KERNELS_AVX2
+template <typename BandBank>
+VOCODER_TARGET_AVX2 void VocoderProcessorT<BandBank>::processBlockAvx2(
+    const float *input, SampleReader *extCarrier, float *output,
+    int numFrames, const float *sharedEnvelopes) {
+  processBlockImpl(input, extCarrier, output, numFrames, sharedEnvelopes);
+}
+#endif
+
+template <typename BandBank>
+VOCODER_ALWAYS_INLINE void VocoderProcessorT<BandBank>::processBlockImpl(
+    const float *input, SampleReader *extCarrier, float *output,
+    int numFrames, const float *sharedEnvelopes) {
+  // Matriz de modulación: rampas por frame avaliadas a taxa de control
+  const bool modActive = mModMatrix.isActive();
+  const float *modIntensity = nullptr;
+  const float *modEcho = nullptr;
+  if (modActive) {
+    using Dest = ModulationMatrix::Destination;
+    mModMatrix.process(input, numFrames);
+    modIntensity = mModMatrix.getRamp(Dest::Intensity);
+    modEcho = mModMatrix.getRamp(Dest::Echo);
+  }
+
+  // Pitch do carrier por frame (pitch base + vibrato)
   for (int frame = 0; frame < numFrames; frame++) {
-    // Obtener valores suavizados por cada frame
     float currentPitch = sBasePitch.process();
     float currentVibrato = sVibratoAmount.process();
+    float vibratoMod = mVibratoLFO.process() * currentVibrato * kVibratoDepthHz;
+    mPitchWork[frame] = currentPitch + vibratoMod;
+  }
+  if (modActive) {
+    mModMatrix.getScaleRamp(ModulationMatrix::Destination::Pitch,
+                            kModPitchOctaves, mModScaleWork.data(),
+                            numFrames);
+    for (int frame = 0; frame < numFrames; frame++) {
+      mPitchWork[frame] *= mModScaleWork[frame];
+    }
+    // O buffer pasa a ter o multiplicador do limiar
+    mModMatrix.getScaleRamp(ModulationMatrix::Destination::Threshold,
+                            kModThresholdOctaves, mModScaleWork.data(),
+                            numFrames);
+  }
+
+  // Carrier aditivo (substitúe oscilador, carrier externo e banco do
+  // carrier): partir de osciladores novos ao activalo
+  const bool additive = mAdditiveMode && mEngine == 0;
+  if (additive && !mAppliedAdditive) {
+    mAdditive.reset();
+  }
+  mAppliedAdditive = additive;
+  if (additive) {
+    extCarrier = nullptr;
+  }
+
+  // Carrier externo: lectura a velocidade variable segundo o pitch
+  if (extCarrier != nullptr) {
+    float rateScale = 1.0f / kCarrierReferencePitch;
+    for (int frame = 0; frame < numFrames; frame++) {
+      mCarrierWork[frame] = mPitchWork[frame] * rateScale;
+    }
+    extCarrier->render(mCarrierWork.data(), mCarrierWork.data(), numFrames);
+  }
+
+  // Cambio de motor: o que entra parte dun estado limpo. Ao volver ao
+  // banco, os filtros e envolventes non deben conservar o son de antes
+  const bool lpc = mEngine == 1;
+  if (mEngine != mAppliedEngine) {
+    if (lpc)
+      mLpc.reset();
+    else
+      resetBands();
+    mAppliedEngine = mEngine;
+  }
+
+  // Envolventes de banda do modulador para todo o bloque: propias ou as
+  // dun procesador que xa analizou a mesma entrada (ver processLayer)
+  const float *envelopes = nullptr;
+  mEnvelopeFrames = 0;
+  if (!lpc) {
+    envelopes = sharedEnvelopes;
+    if (envelopes == nullptr) {
+      analyseModulator(input, numFrames);
+      envelopes = mEnvelopeWork.data();
+      mEnvelopeFrames = numFrames;
+    }
+  }
+
+  // Estéreo: recalcular panorama e limpar o eco dereito ao cambiar de modo
+  const bool stereo = mStereo;
+  if (stereo != mAppliedStereo) {
+    std::fill(mEchoBufferRight.begin(), mEchoBufferRight.end(), 0.0f);
+    mAppliedStereo = stereo;
+  }
+  if (stereo && mStereoWidth != mAppliedWidth) {
+    updatePanning(numFrames);
+  }
+  const bool panRamping = stereo && mPanRamping;
+  const bool softClip = mSoftClip;
+
+  float lastThreshold = 0.0f;
+  for (int frame = 0; frame < numFrames; frame++) {
+    // Obtener valores suavizados por cada frame
     float currentIntensity = sIntensity.process();
     float currentEcho = sEchoAmount.process();
     float currentTremolo = sTremoloAmount.process();
     float currentThreshold = sNoiseThreshold.process();
 
-    // Aplicar vibrato al pitch
-    float vibratoMod = mVibratoLFO.process() * currentVibrato * kVibratoDepthHz;
-    mCarrier.setFrequency(currentPitch + vibratoMod);
+    if (modActive) {
+      currentIntensity = std::max(
+          0.0f, currentIntensity + modIntensity[frame] * kModIntensityRange);
+      currentEcho =
+          std::clamp(currentEcho + modEcho[frame] * kModEchoRange, 0.0f, 0.7f);
+      currentThreshold *= mModScaleWork[frame];
+    }
+    lastThreshold = currentThreshold;
+
+    // Formante: os filtros do carrier (ou os parciais aditivos)
+    // actualízanse por bloque de control
+    if (frame % ModulationMatrix::kControlBlock == 0) {
+      float formant = mFormantShift;
+      if (modActive) {
+        formant += mModMatrix.getControlValue(
+                       ModulationMatrix::Destination::Formant,
+                       frame / ModulationMatrix::kControlBlock) *
+                   kModFormantSemitones;
+      }
+      updateFormant(formant, mFormantChanged);
+      mFormantChanged = false;
+      if (additive) {
+        mAdditive.update(mPitchWork[frame], mCarrierFreqs.data(), kBandQ);
+      }
+    }
 
     // Generar carrier (usar externo se existe, senón usar oscilador)
-    float carrierSample =
-        (extCarrier != nullptr) ? extCarrier[frame] : mCarrier.process();
+    float carrierSample = 0.0f;
+    if (additive) {
+      // Xerado por banda máis abaixo
+    } else if (extCarrier != nullptr) {
+      carrierSample = mCarrierWork[frame];
+    } else {
+      mCarrier.setFrequency(mPitchWork[frame]);
+      carrierSample = mCarrier.process();
+    }
 
-    // Modulador: Preamplificación
-    float modSample = input[frame] * kModulatorPreamp;
+    float outLeft = 0.0f;
+    float outRight = 0.0f;
+    if (lpc) {
+      // Modulador: preamplificación e HPF anti-acople
+      float modSample = mModHPF.process(input[frame] * kModulatorPreamp);
 
-    // Aplicar HPF para quitar retumbo de graves que causa acople
-    modSample = mModHPF.process(modSample);
+      // Carrier filtrado pola envolvente espectral LPC do modulador (centro)
+      outLeft = mLpc.process(modSample, carrierSample, currentThreshold) *
+                currentIntensity * kLpcOutputGain;
+      outRight = outLeft;
+    } else {
+      // Filtrar o carrier en todas as bandas á vez
+      const float *frameEnvelopes = envelopes + frame * kNumBands;
+      if (additive) {
+        mAdditive.process(mCarOut.data());
+      } else {
+        mCarBank.process(carrierSample, mCarOut.data());
+      }
 
-    float outputSample = 0.0f;
-    // Procesar cada banda
-    for (int i = 0; i < kNumBands; i++) {
-      auto &band = mBands[i];
-
-      // Modulador: Filtro e seguidor de envolvente
-      float modFiltered = band.modFilter.process(modSample);
-      float envelope = band.envelope.process(modFiltered);
-
-      // Noise Gate: Solo procesar se supera o umbral
-      // Uso de histéresis para evitar flutuacións rápidas
-      if (envelope > currentThreshold) {
-        float filteredCar = band.carFilter.process(carrierSample);
-        // Boost de envolvente con histéresis suave pro-rata
-        float boost = (envelope - currentThreshold * kThresholdHysteresis);
-        outputSample += filteredCar * boost * currentIntensity;
+      // Procesar cada banda
+      for (int i = 0; i < kNumBands; i++) {
+        float envelope = frameEnvelopes[i];
+
+        // Noise Gate: Solo procesar se supera o umbral
+        // Uso de histéresis para evitar flutuacións rápidas
+        float bandOut = 0.0f;
+        if (envelope > currentThreshold) {
+          // Boost de envolvente con histéresis suave pro-rata
+          float boost = (envelope - currentThreshold * kThresholdHysteresis);
+          bandOut = mCarOut[i] * boost * currentIntensity;
+        }
+        mBandOut[i] = bandOut;
+      }
+
+      // Mestura das bandas nunha soa pasada (vectorizable)
+      if (stereo) {
+        if (panRamping) {
+          for (int i = 0; i < kNumBands; i++) {
+            mPanLeft[i] += mPanLeftStep[i];
+            mPanRight[i] += mPanRightStep[i];
+          }
+        }
+        for (int i = 0; i < kNumBands; i++) {
+          outLeft += mBandOut[i] * mPanLeft[i];
+          outRight += mBandOut[i] * mPanRight[i];
+        }
+      } else {
+        for (int i = 0; i < kNumBands; i++) {
+          outLeft += mBandOut[i];
+        }
       }
     }
 
     // Normalización base de salida
-    outputSample *= kOutputNormalization;
+    outLeft *= kOutputNormalization;
+    outRight *= kOutputNormalization;
 
     // Aplicar tremolo (modulación de amplitud post-vocoder)
     if (currentTremolo > 0.001f) {
       float tremoloMod =
           1.0f - (mTremoloLFO.process() * 0.5f + 0.5f) * currentTremolo;
-      outputSample *= tremoloMod;
+      outLeft *= tremoloMod;
+      outRight *= tremoloMod;
     }
 
     // Aplicar eco con fade-out gradual do buffer para evitar artefactos
     float delayed = mEchoBuffer[mEchoIndex];
+    float delayedRight = mEchoBufferRight[mEchoIndex];
     if (currentEcho > 0.001f) {
-      // Eco activo: comportamento normal
-      outputSample += delayed * currentEcho;
-      mEchoBuffer[mEchoIndex] = outputSample;
+      if (stereo) {
+        // Ping-pong: cada repetición cruza á canle oposta
+        outLeft += delayedRight * currentEcho;
+        outRight += delayed * currentEcho;
+        mEchoBuffer[mEchoIndex] = outLeft;
+        mEchoBufferRight[mEchoIndex] = outRight;
+      } else {
+        // Eco activo: comportamento normal
+        outLeft += delayed * currentEcho;
+        mEchoBuffer[mEchoIndex] = outLeft;
+      }
     } else {
       // Eco inactivo: fade-out gradual do buffer (decay factor 0.95)
       // Isto evita que datos antigos causen clics ao reactivar o eco
       mEchoBuffer[mEchoIndex] = delayed * 0.95f;
+      mEchoBufferRight[mEchoIndex] = delayedRight * 0.95f;
     }
     mEchoIndex = (mEchoIndex + 1) % kEchoSamples;
 
     // Soft-clipper con tanh para saturación musical (evita distorsión dura)
-    outputSample = std::tanh(outputSample);
+    if (softClip) {
+      outLeft = std::tanh(outLeft);
+      outRight = stereo ? std::tanh(outRight) : outLeft;
+    } else if (!stereo) {
+      outRight = outLeft;
+    }
+
+    output[frame * kOutputChannels] = outLeft;
+    output[frame * kOutputChannels + 1] = outRight;
+  }
+
+  // Fin da rampa: fixar as ganancias exactas
+  if (panRamping) {
+    mPanLeft = mPanLeftTarget;
+    mPanRight = mPanRightTarget;
+    mPanRamping = false;
+  }
+
+  updateBandMeters(
+      envelopes != nullptr ? envelopes + (numFrames - 1) * kNumBands : nullptr,
+      lastThreshold);
+}
+
+template <typename BandBank>
+VOCODER_ALWAYS_INLINE void
+VocoderProcessorT<BandBank>::updateBandMeters(const float *envelopes,
+                                              float threshold) {
+  if (envelopes == nullptr) {
+    mMeterEnvelope.fill(0.0f);
+    mMeterReduction.fill(0.0f);
+    return;
+  }
+  // Mesma ganancia que a porta do bucle de bandas: boost / envolvente
+  for (int i = 0; i < kNumBands; i++) {
+    float envelope = envelopes[i];
+    float gain = 0.0f;
+    if (envelope > threshold) {
+      gain = (envelope - threshold * kThresholdHysteresis) / envelope;
+    }
+    mMeterEnvelope[i] = envelope;
+    mMeterReduction[i] = 1.0f - gain;
+  }
+}
 
-    output[frame] = outputSample;
+template <typename BandBank>
+float VocoderProcessorT<BandBank>::followPitch(float detected) const {
+  float midi = 69.0f + 12.0f * std::log2(detected / 440.0f) + mPitchInterval;
+
+  int mask = kScaleMasks[mPitchScale];
+  if (mask != 0) {
+    // Buscar o grao da escala máis próximo
+    int nearest = static_cast<int>(std::lround(midi));
+    for (int offset = 0; offset <= 6; offset++) {
+      int below = nearest - offset;
+      int above = nearest + offset;
+      bool belowIn = (mask >> (((below % 12) + 12) % 12)) & 1;
+      bool aboveIn = (mask >> (((above % 12) + 12) % 12)) & 1;
+      if (belowIn && aboveIn) {
+        nearest = (midi - below <= above - midi) ? below : above;
+        break;
+      }
+      if (belowIn || aboveIn) {
+        nearest = belowIn ? below : above;
+        break;
+      }
+    }
+    midi = static_cast<float>(nearest);
   }
+
+  float freq = 440.0f * std::exp2((midi - 69.0f) / 12.0f);
+  return std::clamp(freq, 50.0f, 400.0f);
 }
 
-void VocoderProcessor::setPitch(float pitch) {
-  sBasePitch.setTarget(std::clamp(pitch, 50.0f, 400.0f));
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setPitch(float pitch) {
+  mManualPitch = std::clamp(pitch, 50.0f, 400.0f);
+  if (!mPitchFollow) {
+    sBasePitch.setTarget(mManualPitch);
+  }
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setFormant(float semitones) {
+  mFormantShift = std::clamp(semitones, -12.0f, 12.0f);
+  mFormantChanged = true;
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setStereo(bool enabled) { mStereo = enabled; }
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setStereoWidth(float width) {
+  mStereoWidth = std::clamp(width, 0.0f, 1.0f);
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setEngine(int engine) {
+  if (engine == 0 || engine == 1) {
+    mEngine = engine;
+  }
 }
 
-void VocoderProcessor::setIntensity(float intensity) {
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setAdditive(bool enabled) {
+  mAdditiveMode = enabled;
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setAdditiveTilt(float tilt) {
+  mAdditive.setTilt(tilt);
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setModSlot(int slot, int source,
+                                             int destination, float depth) {
+  mModMatrix.setSlot(slot, source, destination, depth);
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setModLfo(int index, float rateHz,
+                                            int shape) {
+  mModMatrix.setLfo(index, rateHz, shape);
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setPitchFollow(bool enabled) {
+  if (enabled && !mPitchFollow) {
+    mPitchTracker.reset();
+  }
+  mPitchFollow = enabled;
+  if (!enabled) {
+    // Volver ao pitch do pad
+    sBasePitch.setTarget(mManualPitch);
+  }
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setPitchInterval(float semitones) {
+  mPitchInterval = std::clamp(semitones, -24.0f, 24.0f);
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setPitchScale(int scale) {
+  if (scale >= 0 && scale < static_cast<int>(kScaleMasks.size())) {
+    mPitchScale = scale;
+  }
+}
+
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setIntensity(float intensity) {
   sIntensity.setTarget(
       std::clamp(intensity, 0.2f, 4.0f)); // Aumentado o teito de 3.0 a 4.0
 }
 
-void VocoderProcessor::setWaveform(int type) {
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setWaveform(int type) {
   if (type >= 0 && type <= 3) {
     mCarrier.setWaveform(static_cast<Oscillator::Waveform>(type));
   }
 }
 
-void VocoderProcessor::setVibrato(float amount) {
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setVibrato(float amount) {
   sVibratoAmount.setTarget(std::clamp(amount, 0.0f, 1.0f));
 }
 
-void VocoderProcessor::setEcho(float amount) {
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setEcho(float amount) {
   sEchoAmount.setTarget(std::clamp(amount, 0.0f, 0.7f));
 }
 
-void VocoderProcessor::setTremolo(float amount) {
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setTremolo(float amount) {
   sTremoloAmount.setTarget(std::clamp(amount, 0.0f, 1.0f));
 }
 
-void VocoderProcessor::setNoiseThreshold(float threshold) {
+template <typename BandBank>
+void VocoderProcessorT<BandBank>::setNoiseThreshold(float threshold) {
   sNoiseThreshold.setTarget(std::clamp(threshold, 0.005f, 0.2f));
 }
+
+// A app só compila a topoloxía escollida; as ferramentas de host que
+// comparan topoloxías definen VOCODER_ALL_BAND_FILTERS
+#if defined(VOCODER_ALL_BAND_FILTERS)
+template class VocoderProcessorT<RbjBandpassBank<kVocoderBands>>;
+template class VocoderProcessorT<TdfIIBandpassBank<kVocoderBands>>;
+template class VocoderProcessorT<SvfBandpassBank<kVocoderBands>>;
+template class VocoderProcessorT<CascadedBandpassBank<kVocoderBands>>;
+#else
+template class VocoderProcessorT<VocoderBandBank>;
+#endif
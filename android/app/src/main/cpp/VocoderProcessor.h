@@ -1,22 +1,61 @@
 #pragma once
 
+#include "AdditiveCarrier.h"
+#include "CpuFeatures.h"
 #include "DSPComponents.h"
+#include "FilterBanks.h"
+#include "LpcVocoder.h"
+#include "ModulationMatrix.h"
+#include "PitchTracker.h"
+#include "SampleReader.h"
 #include <array>
 #include <vector>
 
+static constexpr int kVocoderBands = 20;
+
 /**
  * Procesador de vocoder con 20 bandas.
  * Analiza la señal moduladora y aplica su envolvente al carrier.
+ *
+ * BandBank é a topoloxía dos filtros de banda (ver FilterBanks.h); a
+ * versión usada pola app escóllese en compilación con VOCODER_BAND_FILTER.
  */
-class VocoderProcessor {
+template <typename BandBank> class VocoderProcessorT {
 public:
-  static constexpr int kNumBands = 20;
+  static constexpr int kNumBands = kVocoderBands;
+  static_assert(BandBank::kSize == kNumBands, "Band bank size mismatch");
+  static constexpr int kMaxBlockFrames = 256;
+  static constexpr int kOutputChannels = 2;
+
+  VocoderProcessorT(float sampleRate);
+
+  static const char *getFilterName() { return BandBank::kName; }
 
-  VocoderProcessor(float sampleRate);
+  // Volve aos parámetros e estado iniciais no sitio, sen reservar memoria
+  // (apto para o callback). Conserva a variante de kernels e o soft-clip
+  void reset();
 
-  void process(const float *input, const float *extCarrier, float *output,
+  // extCarrier: lector do carrier externo (nullptr = oscilador interno).
+  // A súa velocidade segue o pitch e o vibrato.
+  // output: estéreo intercalado (L R L R...), numFrames * kOutputChannels.
+  void process(const float *input, SampleReader *extCarrier, float *output,
                int numFrames);
 
+  // Capa sobre outro procesador: chamar xusto despois de leader.process()
+  // coa mesma entrada (numFrames <= kMaxBlockFrames). Reutiliza as
+  // envolventes de banda do líder en vez de analizar outra vez o modulador.
+  void processLayer(const VocoderProcessorT &leader, const float *input,
+                    SampleReader *extCarrier, float *output, int numFrames);
+
+  // Soft-clip tanh á saída (activo por defecto). Sen el a saída pode
+  // pasar de ±1: para sumar varios procesadores e saturar só a mestura
+  void setSoftClip(bool enabled);
+
+  // Variante dos kernels DSP (ver CpuFeatures.h). Se a CPU non a admite
+  // úsase a xenérica
+  void setKernelVariant(KernelVariant variant);
+  KernelVariant getKernelVariant() const { return mKernelVariant; }
+
   // Parámetros
   void setPitch(float pitch);
   void setIntensity(float intensity);
@@ -25,9 +64,49 @@ public:
   void setEcho(float amount);
   void setTremolo(float amount);
   void setNoiseThreshold(float threshold);
+  void setFormant(float semitones); // Desprazamento das bandas do carrier
+  void setStereo(bool enabled);     // Bandas repartidas e eco ping-pong
+  void setStereoWidth(float width); // 0 = centro, 1 = bandas nos extremos
+  // 0 = Banco de filtros, 1 = LPC (custo baixo, son de sintetizador de voz;
+  // o formante e o panorama por bandas só afectan ao banco)
+  void setEngine(int engine);
+  // Carrier aditivo: parciais harmónicos sintetizados por banda en vez
+  // de filtrar o oscilador (só co banco de filtros; ignora o carrier
+  // externo). tilt: 0 = brillante, 1 = serra, 2 = escuro
+  void setAdditive(bool enabled);
+  void setAdditiveTilt(float tilt);
+
+  // Matriz de modulación (ver ModulationMatrix::Source / Destination)
+  void setModSlot(int slot, int source, int destination, float depth);
+  void setModLfo(int index, float rateHz, int shape);
+
+  // Seguimento de pitch: o carrier segue a f0 do modulador
+  void setPitchFollow(bool enabled);
+  void setPitchInterval(float semitones);
+  void setPitchScale(int scale); // 0 = Libre, 1 = Cromática, 2 = Maior,
+                                 // 3 = Menor, 4 = Pentatónica
+
+  float getDetectedPitch() const { return mPitchTracker.getFrequency(); }
+  float getPitchConfidence() const { return mPitchTracker.getConfidence(); }
+  float getPitchTrackerLatencyMs() const {
+    return mPitchTracker.getLatencyMs();
+  }
+  float getPitchTrackerLoad() const { return mPitchTracker.getCpuLoad(); }
+
+  // Medidores por banda (un valor por bloque): envolvente do modulador e
+  // redución de ganancia da porta de ruído (0 = aberta, 1 = pechada).
+  // A cero co motor LPC, que non usa as bandas
+  const std::array<float, kNumBands> &getBandEnvelopes() const {
+    return mMeterEnvelope;
+  }
+  const std::array<float, kNumBands> &getBandGainReduction() const {
+    return mMeterReduction;
+  }
 
 private:
   float mSampleRate;
+  KernelVariant mKernelVariant = KernelVariant::Generic;
+  bool mSoftClip = true;
 
   // Suavizadores de parámetros para evitar clics
   ParameterSmoother sIntensity;
@@ -46,20 +125,75 @@ private:
   // LFO para tremolo
   Oscillator mTremoloLFO;
 
+  // Detector de pitch do modulador
+  PitchTracker mPitchTracker;
+  bool mPitchFollow = false;
+  float mPitchInterval = 0.0f;
+  int mPitchScale = 0;
+  float mManualPitch = 140.0f;
+
+  // Matriz de modulación a taxa de control
+  ModulationMatrix mModMatrix;
+  float mFormantShift = 0.0f;
+  float mAppliedFormant = 0.0f;
+  bool mFormantChanged = false; // Cambio do usuario: sen histérese
+
+  // Motor alternativo por predición lineal
+  LpcVocoder mLpc;
+  int mEngine = 0;
+  int mAppliedEngine = 0;
+
+  // Carrier aditivo e frecuencias centrais actuais do carrier
+  AdditiveCarrier<kNumBands> mAdditive;
+  bool mAdditiveMode = false;
+  bool mAppliedAdditive = false;
+  std::array<float, kNumBands> mCarrierFreqs{};
+
   // Filtro pasa-altos para el modulador (anti-rumble/acople)
   HighPassFilter mModHPF;
 
   // Bandas del vocoder
   struct Band {
-    BandpassFilter modFilter;
-    BandpassFilter carFilter;
     EnvelopeFollower envelope;
     float frequency;
   };
   std::array<Band, kNumBands> mBands;
 
-  // Buffer de eco
+  // Bancos de filtros (modulador e carrier) e as súas saídas por frame
+  BandBank mModBank;
+  BandBank mCarBank;
+  std::array<float, kNumBands> mModOut{};
+  std::array<float, kNumBands> mCarOut{};
+
+  // Envolventes do modulador do último bloque, [frame][banda]
+  std::array<float, kMaxBlockFrames * kNumBands> mEnvelopeWork{};
+  int mEnvelopeFrames = 0; // 0 se o último bloque non as calculou
+
+  // Buffers de traballo por bloque
+  std::array<float, kMaxBlockFrames> mPitchWork{};
+  std::array<float, kMaxBlockFrames> mCarrierWork{};
+  std::array<float, kMaxBlockFrames> mModScaleWork{};
+
+  // Estéreo: ganancias L/R por banda (en rampa ao cambiar o ancho) e
+  // saídas de banda do frame actual
+  bool mStereo = false;
+  bool mAppliedStereo = false;
+  float mStereoWidth = 0.7f;
+  float mAppliedWidth = -1.0f;
+  std::array<float, kNumBands> mBandOut{};
+  std::array<float, kNumBands> mMeterEnvelope{};
+  std::array<float, kNumBands> mMeterReduction{};
+  std::array<float, kNumBands> mPanLeft{};
+  std::array<float, kNumBands> mPanRight{};
+  std::array<float, kNumBands> mPanLeftTarget{};
+  std::array<float, kNumBands> mPanRightTarget{};
+  std::array<float, kNumBands> mPanLeftStep{};
+  std::array<float, kNumBands> mPanRightStep{};
+  bool mPanRamping = false;
+
+  // Buffer de eco (o dereito só se usa no ping-pong estéreo)
   std::vector<float> mEchoBuffer;
+  std::vector<float> mEchoBufferRight;
   int mEchoIndex = 0;
   static constexpr int kEchoSamples = 14400; // 300ms @ 48kHz
 
@@ -70,4 +204,49 @@ private:
       2150, 2600, 3100, 3700, 4400, 5300, 6500, 8000, 10500, 14000};
 
   void initBands();
+  void resetBands();
+  void updateFormant(float semitones, bool force);
+  void updatePanning(int numFrames);
+  VOCODER_ALWAYS_INLINE void updateBandMeters(const float *envelopes,
+                                              float threshold);
+  void trackPitch(const float *input, int numFrames);
+  VOCODER_ALWAYS_INLINE void analyseModulator(const float *input,
+                                              int numFrames);
+  void processBlock(const float *input, SampleReader *extCarrier,
+                    float *output, int numFrames,
+                    const float *sharedEnvelopes);
+  // Corpo de processBlock, compilado unha vez por variante de kernels
+  VOCODER_ALWAYS_INLINE void processBlockImpl(const float *input,
+                                              SampleReader *extCarrier,
+                                              float *output, int numFrames,
+                                              const float *sharedEnvelopes);
+#if VOCODER_KERNELS_AVX2
+  VOCODER_TARGET_AVX2 void processBlockAvx2(const float *input,
+                                            SampleReader *extCarrier,
+                                            float *output, int numFrames,
+                                            const float *sharedEnvelopes);
+#endif
+  float followPitch(float detected) const;
 };
+
+// Topoloxía de filtro escollida en compilación (-DVOCODER_BAND_FILTER=...)
+#if defined(VOCODER_BAND_FILTER_SVF)
+using VocoderBandBank = SvfBandpassBank<kVocoderBands>;
+#elif defined(VOCODER_BAND_FILTER_TDF2)
+using VocoderBandBank = TdfIIBandpassBank<kVocoderBands>;
+#elif defined(VOCODER_BAND_FILTER_CASCADE)
+using VocoderBandBank = CascadedBandpassBank<kVocoderBands>;
+#else
+using VocoderBandBank = RbjBandpassBank<kVocoderBands>;
+#endif
+
+using VocoderProcessor = VocoderProcessorT<VocoderBandBank>;
+
+#if defined(VOCODER_ALL_BAND_FILTERS)
+extern template class VocoderProcessorT<RbjBandpassBank<kVocoderBands>>;
+extern template class VocoderProcessorT<TdfIIBandpassBank<kVocoderBands>>;
+extern template class VocoderProcessorT<SvfBandpassBank<kVocoderBands>>;
+extern template class VocoderProcessorT<CascadedBandpassBank<kVocoderBands>>;
+#else
+extern template class VocoderProcessorT<VocoderBandBank>;
+#endif
@@ -12,6 +12,15 @@ Java_com_tonetxo_vocodergal_audio_VocoderBridge_create(JNIEnv *env,
   }
 }
 
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_prepare(JNIEnv *env,
+                                                        jobject thiz) {
+  if (engine != nullptr) {
+    return engine->prepare();
+  }
+  return false;
+}
+
 extern "C" JNIEXPORT jboolean JNICALL
 Java_com_tonetxo_vocodergal_audio_VocoderBridge_start(JNIEnv *env,
                                                       jobject thiz) {
@@ -29,6 +38,14 @@ Java_com_tonetxo_vocodergal_audio_VocoderBridge_stop(JNIEnv *env,
   }
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_release(JNIEnv *env,
+                                                        jobject thiz) {
+  if (engine != nullptr) {
+    engine->release();
+  }
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_tonetxo_vocodergal_audio_VocoderBridge_destroy(JNIEnv *env,
                                                         jobject thiz) {
@@ -100,6 +117,105 @@ Java_com_tonetxo_vocodergal_audio_VocoderBridge_setNoiseThreshold(
   }
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_setFormant(JNIEnv *env,
+                                                           jobject thiz,
+                                                           jfloat semitones) {
+  if (engine != nullptr) {
+    engine->setFormant(semitones);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_setStereo(JNIEnv *env,
+                                                          jobject thiz,
+                                                          jboolean enabled) {
+  if (engine != nullptr) {
+    engine->setStereo(enabled);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_setStereoWidth(JNIEnv *env,
+                                                               jobject thiz,
+                                                               jfloat width) {
+  if (engine != nullptr) {
+    engine->setStereoWidth(width);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_setEngine(JNIEnv *env,
+                                                          jobject thiz,
+                                                          jint type) {
+  if (engine != nullptr) {
+    engine->setEngine(type);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_setAdditive(JNIEnv *env,
+                                                            jobject thiz,
+                                                            jboolean enabled) {
+  if (engine != nullptr) {
+    engine->setAdditive(enabled);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_setAdditiveTilt(JNIEnv *env,
+                                                                jobject thiz,
+                                                                jfloat tilt) {
+  if (engine != nullptr) {
+    engine->setAdditiveTilt(tilt);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_setModSlot(
+    JNIEnv *env, jobject thiz, jint slot, jint source, jint destination,
+    jfloat depth) {
+  if (engine != nullptr) {
+    engine->setModSlot(slot, source, destination, depth);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_setModLfo(JNIEnv *env,
+                                                          jobject thiz,
+                                                          jint index,
+                                                          jfloat rateHz,
+                                                          jint shape) {
+  if (engine != nullptr) {
+    engine->setModLfo(index, rateHz, shape);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_setPitchFollow(
+    JNIEnv *env, jobject thiz, jboolean enabled) {
+  if (engine != nullptr) {
+    engine->setPitchFollow(enabled);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_setPitchInterval(
+    JNIEnv *env, jobject thiz, jfloat semitones) {
+  if (engine != nullptr) {
+    engine->setPitchInterval(semitones);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_setPitchScale(JNIEnv *env,
+                                                              jobject thiz,
+                                                              jint scale) {
+  if (engine != nullptr) {
+    engine->setPitchScale(scale);
+  }
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_tonetxo_vocodergal_audio_VocoderBridge_setMicActive(JNIEnv *env,
                                                              jobject thiz,
@@ -145,6 +261,15 @@ Java_com_tonetxo_vocodergal_audio_VocoderBridge_resetFileIndex(JNIEnv *env,
   }
 }
 
+extern "C" JNIEXPORT void JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_setFileSpeed(JNIEnv *env,
+                                                             jobject thiz,
+                                                             jfloat speed) {
+  if (engine != nullptr) {
+    engine->setFileSpeed(speed);
+  }
+}
+
 extern "C" JNIEXPORT void JNICALL
 Java_com_tonetxo_vocodergal_audio_VocoderBridge_loadCarrierData(
     JNIEnv *env, jobject thiz, jfloatArray data) {
@@ -172,6 +297,62 @@ Java_com_tonetxo_vocodergal_audio_VocoderBridge_stopRecording(JNIEnv *env,
   }
 }
 
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_isRecordingFull(JNIEnv *env,
+                                                                jobject thiz) {
+  return engine != nullptr && engine->isRecordingFull();
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_startCapture(JNIEnv *env,
+                                                             jobject thiz,
+                                                             jstring path) {
+  if (engine == nullptr || path == nullptr) {
+    return false;
+  }
+  const char *cPath = env->GetStringUTFChars(path, nullptr);
+  bool started = engine->startCapture(cPath);
+  env->ReleaseStringUTFChars(path, cPath);
+  return started;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_stopCapture(JNIEnv *env,
+                                                            jobject thiz) {
+  return engine == nullptr || engine->stopCapture();
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_createLayer(JNIEnv *env,
+                                                            jobject thiz) {
+  if (engine != nullptr) {
+    return engine->createLayer();
+  }
+  return -1;
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_destroyLayer(JNIEnv *env,
+                                                             jobject thiz,
+                                                             jint handle) {
+  if (engine != nullptr) {
+    engine->destroyLayer(handle);
+  }
+}
+
+extern "C" JNIEXPORT void JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_setLayerParam(
+    JNIEnv *env, jobject thiz, jint handle, jint param, jint index, jint a,
+    jint b, jfloat value) {
+  if (engine != nullptr && param >= 0 &&
+      param < static_cast<jint>(ParamId::Count) &&
+      isValidParamChange(static_cast<ParamId>(param), index, a, b)) {
+    engine->postLayerParam(
+        handle, {static_cast<ParamId>(param), static_cast<uint8_t>(index),
+                 static_cast<int8_t>(a), static_cast<int8_t>(b), value});
+  }
+}
+
 extern "C" JNIEXPORT jfloat JNICALL
 Java_com_tonetxo_vocodergal_audio_VocoderBridge_getVULevel(JNIEnv *env,
                                                            jobject thiz) {
@@ -192,3 +373,79 @@ Java_com_tonetxo_vocodergal_audio_VocoderBridge_getWaveformData(JNIEnv *env,
   }
   return nullptr;
 }
+
+// Enche o array do chamador sen reservar memoria:
+// [0, n) envolventes, [n, 2n) redución de ganancia. Devolve n (ou 0)
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_getBandLevels(JNIEnv *env,
+                                                              jobject thiz,
+                                                              jfloatArray out) {
+  constexpr int kBands = BandMeterSnapshot::kNumBands;
+  if (engine == nullptr || out == nullptr ||
+      env->GetArrayLength(out) < 2 * kBands) {
+    return 0;
+  }
+  float levels[2 * kBands];
+  int bands = engine->getBandLevels(levels, levels + kBands);
+  if (bands > 0) {
+    env->SetFloatArrayRegion(out, 0, 2 * bands, levels);
+  }
+  return bands;
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_getBandCount(JNIEnv *env,
+                                                             jobject thiz) {
+  return BandMeterSnapshot::kNumBands;
+}
+
+extern "C" JNIEXPORT jfloatArray JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_getPitchInfo(JNIEnv *env,
+                                                             jobject thiz) {
+  if (engine != nullptr) {
+    auto data = engine->getPitchInfo();
+    jfloatArray result = env->NewFloatArray(data.size());
+    env->SetFloatArrayRegion(result, 0, data.size(), data.data());
+    return result;
+  }
+  return nullptr;
+}
+
+extern "C" JNIEXPORT jfloat JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_getFileStretchLoad(
+    JNIEnv *env, jobject thiz) {
+  if (engine != nullptr) {
+    return engine->getFileStretchLoad();
+  }
+  return 0.0f;
+}
+
+extern "C" JNIEXPORT jfloatArray JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_getStartInfo(JNIEnv *env,
+                                                             jobject thiz) {
+  if (engine != nullptr) {
+    auto data = engine->getStartInfo();
+    jfloatArray result = env->NewFloatArray(data.size());
+    env->SetFloatArrayRegion(result, 0, data.size(), data.data());
+    return result;
+  }
+  return nullptr;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_setKernelVariant(
+    JNIEnv *env, jobject thiz, jint variant) {
+  if (engine != nullptr) {
+    return engine->setKernelVariant(variant);
+  }
+  return false;
+}
+
+extern "C" JNIEXPORT jint JNICALL
+Java_com_tonetxo_vocodergal_audio_VocoderBridge_getKernelVariant(JNIEnv *env,
+                                                                 jobject thiz) {
+  if (engine != nullptr) {
+    return engine->getKernelVariant();
+  }
+  return 0;
+}
@@ -9,8 +9,10 @@ class VocoderBridge {
     }
 
     external fun create()
+    external fun prepare(): Boolean // Abre os streams en standby
     external fun start(): Boolean
     external fun stop()
+    external fun release() // Pecha os streams en standby; prepare() vólveos abrir
     external fun destroy()
 
     // Parámetros
@@ -21,6 +23,23 @@ class VocoderBridge {
     external fun setEcho(amount: Float)
     external fun setTremolo(amount: Float)
     external fun setNoiseThreshold(threshold: Float)
+    external fun setFormant(semitones: Float)
+    external fun setStereo(enabled: Boolean)
+    external fun setStereoWidth(width: Float) // 0 = centro, 1 = bandas nos extremos
+    external fun setEngine(type: Int) // 0 = Banco de filtros, 1 = LPC (baixo consumo)
+    external fun setAdditive(enabled: Boolean) // Carrier de parciais harmónicos por banda
+    external fun setAdditiveTilt(tilt: Float) // 0 = brillante, 1 = serra, 2 = escuro
+
+    // Matriz de modulación
+    // source: 0-2 = LFO 1-3, 3 = Envolvente, 4 = Nivel do modulador
+    // destination: 0 = Ton, 1 = Intensidade, 2 = Eco, 3 = Limiar, 4 = Formante
+    external fun setModSlot(slot: Int, source: Int, destination: Int, depth: Float)
+    external fun setModLfo(index: Int, rateHz: Float, shape: Int) // shape: 0 = Saw, 1 = Square, 2 = Tri, 3 = Sine
+
+    // Seguimento de pitch do modulador
+    external fun setPitchFollow(enabled: Boolean)
+    external fun setPitchInterval(semitones: Float)
+    external fun setPitchScale(scale: Int) // 0 = Libre, 1 = Cromática, 2 = Maior, 3 = Menor, 4 = Pentatónica
     
     // Gestión de fuente y datos
     external fun setMicActive(active: Boolean)
@@ -28,13 +47,63 @@ class VocoderBridge {
     external fun loadModulatorData(data: FloatArray)
     external fun setFilePlaying(playing: Boolean)
     external fun resetFileIndex()
+    external fun setFileSpeed(speed: Float) // 0.25x - 2x
     external fun loadCarrierData(data: FloatArray)
     
     // Grabación Interna
     external fun startRecording()
     external fun stopRecording()
+    // true se a gravación se detivo soa ao chegar á duración máxima (60 s);
+    // hai que chamar igualmente a stopRecording() para cargala
+    external fun isRecordingFull(): Boolean
+
+    // Captura de sesión para reproducir no host (tools/session_replay)
+    external fun startCapture(path: String): Boolean
+    external fun stopCapture(): Boolean // false se fallou a escritura (sesión incompleta)
+
+    // Capas: outro vocoder sobre o mesmo modulador (p.ex. unha oitava abaixo),
+    // que parte dos parámetros actuais da capa principal
+    external fun createLayer(): Int // handle, ou -1 se non quedan capas
+    external fun destroyLayer(handle: Int)
+    // Cambio de parámetro dunha capa (handle 0 = principal), ver LayerParam
+    external fun setLayerParam(handle: Int, param: Int, index: Int, a: Int, b: Int, value: Float)
 
     // Visualización
     external fun getVULevel(): Float
     external fun getWaveformData(): FloatArray
+    // Medidores por banda nun array reutilizable de 2 * getBandCount():
+    // envolventes (lineal) e logo redución da porta (0 = aberta, 1 = pechada).
+    // Devolve o número de bandas escritas (0 se non hai datos)
+    external fun getBandCount(): Int
+    external fun getBandLevels(out: FloatArray): Int
+    external fun getPitchInfo(): FloatArray // [f0 Hz, confianza, latencia ms, carga CPU]
+    external fun getFileStretchLoad(): Float
+    external fun getStartInfo(): FloatArray // [ms arranque frío, ms arranque quente, reaperturas]
+
+    // Kernels DSP: -1 = automático, 0 = xenérico, 1 = AVX2 (x86). Para probas
+    external fun setKernelVariant(variant: Int): Boolean
+    external fun getKernelVariant(): Int
+
+    // Identificadores de setLayerParam: mesma orde que ParamId (ParameterMailbox.h).
+    // Os valores van en value, agás os marcados con "a" (enteiros ou 0/1)
+    object LayerParam {
+        const val PITCH = 0
+        const val INTENSITY = 1
+        const val WAVEFORM = 2 // a (4 = carrier externo, cada capa co seu lector)
+        const val VIBRATO = 3
+        const val ECHO = 4
+        const val TREMOLO = 5
+        const val NOISE_THRESHOLD = 6
+        const val FORMANT = 7
+        const val STEREO = 8 // a
+        const val STEREO_WIDTH = 9
+        const val MOD_SLOT = 10 // index = slot, a = fonte, b = destino, value = depth
+        const val MOD_LFO = 11 // index = LFO, a = forma, value = Hz
+        const val PITCH_FOLLOW = 12 // a
+        const val PITCH_INTERVAL = 13
+        const val PITCH_SCALE = 14 // a
+        const val ENGINE = 15 // a
+        const val ADDITIVE = 16 // a
+        const val ADDITIVE_TILT = 17
+    }
 }
@@ -1,5 +1,6 @@
 package com.tonetxo.vocodergal.ui
 
+import android.widget.Toast
 import androidx.compose.animation.core.animateFloat
 import androidx.compose.animation.core.infiniteRepeatable
 import androidx.compose.animation.core.rememberInfiniteTransition
@@ -21,6 +22,7 @@ import androidx.compose.material.icons.filled.Stop
 import androidx.compose.material.icons.filled.HelpOutline
 import androidx.compose.material3.*
 import androidx.compose.runtime.*
+import androidx.compose.ui.platform.LocalContext
 import androidx.compose.ui.platform.LocalUriHandler
 import androidx.compose.ui.Alignment
 import androidx.compose.ui.Modifier
@@ -61,9 +63,19 @@ fun VocoderScreen(
     val hasFileLoaded by viewModel.hasFileLoaded.collectAsState()
     val isDecoding by viewModel.isDecoding.collectAsState()
     val isRecording by viewModel.isRecording.collectAsState()
+    val recordingLimitReached by viewModel.recordingLimitReached.collectAsState()
     var resetTrigger by remember { mutableStateOf(0) }
     var showInfoDialog by remember { mutableStateOf(false) }
     val uriHandler = LocalUriHandler.current
+    val context = LocalContext.current
+
+    // Aviso cando o motor detén a gravación por duración
+    LaunchedEffect(recordingLimitReached) {
+        if (recordingLimitReached) {
+            Toast.makeText(context, "Gravación detida: duración máxima", Toast.LENGTH_SHORT).show()
+            viewModel.clearRecordingLimitReached()
+        }
+    }
 
     // Animación de parpadeo para el botón REC
     val infiniteTransition = rememberInfiniteTransition(label = "blink")
@@ -84,6 +84,10 @@ class VocoderViewModel : ViewModel() {
     private val _isRecording = MutableStateFlow(false)
     val isRecording: StateFlow<Boolean> = _isRecording.asStateFlow()
 
+    // A gravación detívose soa ao chegar á duración máxima do motor
+    private val _recordingLimitReached = MutableStateFlow(false)
+    val recordingLimitReached: StateFlow<Boolean> = _recordingLimitReached.asStateFlow()
+
     private val _tremolo = MutableStateFlow(0f)
     val tremolo: StateFlow<Float> = _tremolo.asStateFlow()
 
@@ -96,6 +100,19 @@ class VocoderViewModel : ViewModel() {
     fun onPermissionGranted() {
         Log.d(TAG, "Permission granted")
         hasPermission = true
+        // Abrir os streams en standby para que o encendido sexa inmediato
+        bridge.prepare()
+    }
+
+    // En segundo plano os streams exclusivos en standby reservarían o micro
+    // e a saída de baixa latencia para outras apps: pecharlos se non está
+    // a soar e volver abrilos ao regresar
+    fun onBackground() {
+        bridge.release()
+    }
+
+    fun onForeground() {
+        if (hasPermission) bridge.prepare()
     }
     
     private fun startUIUpdates() {
@@ -105,6 +122,11 @@ class VocoderViewModel : ViewModel() {
                     _vuLevel.value = bridge.getVULevel()
                     _waveformData.value = bridge.getWaveformData()
                 }
+                if (_isRecording.value && bridge.isRecordingFull()) {
+                    Log.d(TAG, "Recording length limit reached")
+                    stopRecording()
+                    _recordingLimitReached.value = true
+                }
                 delay(16) // ~60 FPS
             }
         }
@@ -164,6 +186,10 @@ class VocoderViewModel : ViewModel() {
         }
     }
 
+    fun clearRecordingLimitReached() {
+        _recordingLimitReached.value = false
+    }
+
     private fun startRecording() {
         Log.d(TAG, "Starting internal recording in C++ engine")
         // Asegurar que el motor esté encendido para poder grabar
@@ -0,0 +1,319 @@
+// Mide no host o custo dos bloques DSP da app con sinais sintéticos, en
+// bloques de 256 frames coma os callbacks do VocoderEngine. O procesador
+// usa a topoloxía de filtro de VOCODER_BAND_FILTER, coma na app, agás en
+// "banks", que compara as catro.
+//
+//   dsp_bench [nome ...] [--seconds S] [--repeat N]
+//
+// Sen nomes execútanse todas as medidas. Para cada caso infórmase do
+// mellor tempo medio por bloque (de N repeticións), do bloque máis lento e
+// da porcentaxe do orzamento en tempo real dun bloque (256 / 48 kHz).
+
+#include "SampleBuffer.h"
+#include "TimeStretcher.h"
+#include "VocoderProcessor.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr float kSampleRate = 48000.0f;
+constexpr int kBlockFrames = 256;
+
+struct Options {
+  float seconds = 10.0f;
+  int repeat = 5;
+};
+
+struct Timing {
+  double meanNs = 0.0; // Por bloque, mellor repetición
+  double worstNs = 0.0;
+};
+
+// Voz sintética: pulsos glotais a 120 Hz por dous formantes, con pausas
+std::vector<float> makeSpeechLike(int numSamples) {
+  std::vector<float> out(numSamples);
+  std::minstd_rand rng(1234);
+  std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+  float f1 = 0.0f, f1v = 0.0f, f2 = 0.0f, f2v = 0.0f;
+  for (int i = 0; i < numSamples; i++) {
+    float t = i / kSampleRate;
+    float excitation = (i % 400 == 0) ? 1.0f : 0.02f * noise(rng);
+    // Resonadores de 2º orde a 700 e 1200 Hz
+    f1v += 0.26f * (excitation - f1) - 0.02f * f1v;
+    f1 += f1v * 0.26f;
+    f2v += 0.45f * (excitation - f2) - 0.03f * f2v;
+    f2 += f2v * 0.45f;
+    float gate = std::fmod(t, 1.5f) < 1.1f ? 1.0f : 0.0f;
+    out[i] = 0.3f * gate * (f1 + 0.5f * f2);
+  }
+  return out;
+}
+
+template <typename Fn>
+Timing timeBlocks(int numBlocks, int repeat, Fn &&block) {
+  using Clock = std::chrono::steady_clock;
+  Timing best{1e300, 0.0};
+  for (int r = 0; r < repeat; r++) {
+    double total = 0.0;
+    double worst = 0.0;
+    for (int b = 0; b < numBlocks; b++) {
+      auto t0 = Clock::now();
+      block(b);
+      double ns =
+          std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+      total += ns;
+      worst = std::max(worst, ns);
+    }
+    if (total / numBlocks < best.meanNs) {
+      best.meanNs = total / numBlocks;
+      best.worstNs = worst;
+    }
+  }
+  return best;
+}
+
+void report(const char *name, const Timing &timing) {
+  const double budgetNs = 1e9 * kBlockFrames / kSampleRate;
+  std::printf("%-28s %9.0f ns/block  worst %9.0f ns  %6.2f%% of real time\n",
+              name, timing.meanNs, timing.worstNs,
+              100.0 * timing.meanNs / budgetNs);
+}
+
+// Volátil para que o compilador non descarte o cálculo
+volatile float gSink = 0.0f;
+
+void benchStretch(const Options &options) {
+  const int numBlocks =
+      static_cast<int>(options.seconds * kSampleRate) / kBlockFrames;
+  std::vector<float> source = makeSpeechLike(static_cast<int>(kSampleRate) * 4);
+  SampleBuffer buffer;
+  buffer.assign(source.data(), static_cast<int32_t>(source.size()));
+
+  std::vector<float> output(kBlockFrames);
+  for (float speed : {0.25f, 0.5f, 1.0f, 1.5f, 2.0f}) {
+    TimeStretcher stretcher(kSampleRate);
+    stretcher.setSource(buffer.data(), buffer.size());
+    stretcher.setSpeed(speed);
+    Timing timing = timeBlocks(numBlocks, options.repeat, [&](int) {
+      stretcher.render(output.data(), kBlockFrames);
+      gSink = gSink + output[kBlockFrames - 1];
+    });
+    char name[64];
+    std::snprintf(name, sizeof(name), "stretch %.2fx", speed);
+    report(name, timing);
+  }
+}
+
+// Procesador completo (banco de filtros, oscilador) en mono e estéreo.
+// "stereo sweep" move o ancho en cada bloque, de xeito que as ganancias
+// de panorama están sempre en rampa
+void benchStereo(const Options &options) {
+  const int numBlocks =
+      static_cast<int>(options.seconds * kSampleRate) / kBlockFrames;
+  std::vector<float> input =
+      makeSpeechLike(numBlocks * kBlockFrames + kBlockFrames);
+  std::vector<float> output(kBlockFrames * VocoderProcessor::kOutputChannels);
+
+  struct Case {
+    const char *name;
+    bool stereo;
+    bool sweep;
+  };
+  for (const Case &c : {Case{"processor mono", false, false},
+                        Case{"processor stereo", true, false},
+                        Case{"processor stereo sweep", true, true}}) {
+    VocoderProcessor processor(kSampleRate);
+    processor.setStereo(c.stereo);
+    Timing timing = timeBlocks(numBlocks, options.repeat, [&](int b) {
+      if (c.sweep)
+        processor.setStereoWidth(0.5f + 0.5f * std::sin(b * 0.05f));
+      processor.process(input.data() + b * kBlockFrames, nullptr,
+                        output.data(), kBlockFrames);
+      gSink = gSink + output[1];
+    });
+    report(c.name, timing);
+  }
+}
+
+// Un banco de filtros só (20 bandas, unha mostra de cada vez) e o
+// procesador completo con esa topoloxía
+template <typename BandBank>
+void benchBank(const Options &options, const std::vector<float> &input,
+               int numBlocks) {
+  BandBank bank;
+  for (int i = 0; i < BandBank::kSize; i++) {
+    float freq = 100.0f * std::pow(140.0f, i / (BandBank::kSize - 1.0f));
+    bank.setBand(i, freq, 12.0f, kSampleRate);
+  }
+  std::vector<float> bands(BandBank::kSize);
+  Timing bankTiming = timeBlocks(numBlocks, options.repeat, [&](int b) {
+    const float *block = input.data() + b * kBlockFrames;
+    for (int i = 0; i < kBlockFrames; i++)
+      bank.process(block[i], bands.data());
+    gSink = gSink + bands[0];
+  });
+
+  std::vector<float> output(kBlockFrames * 2);
+  VocoderProcessorT<BandBank> processor(kSampleRate);
+  Timing processorTiming = timeBlocks(numBlocks, options.repeat, [&](int b) {
+    processor.process(input.data() + b * kBlockFrames, nullptr, output.data(),
+                      kBlockFrames);
+    gSink = gSink + output[0];
+  });
+
+  std::printf("%s\n", BandBank::kName);
+  report("  bank only", bankTiming);
+  report("  processor", processorTiming);
+}
+
+void benchBanks(const Options &options) {
+  const int numBlocks =
+      static_cast<int>(options.seconds * kSampleRate) / kBlockFrames;
+  std::vector<float> input =
+      makeSpeechLike(numBlocks * kBlockFrames + kBlockFrames);
+  benchBank<RbjBandpassBank<kVocoderBands>>(options, input, numBlocks);
+  benchBank<TdfIIBandpassBank<kVocoderBands>>(options, input, numBlocks);
+  benchBank<SvfBandpassBank<kVocoderBands>>(options, input, numBlocks);
+  benchBank<CascadedBandpassBank<kVocoderBands>>(options, input, numBlocks);
+}
+
+// Carrier por bandas: oscilador de serra polo banco RBJ do carrier fronte
+// ao carrier aditivo (update por bloque de control), con pitch fixo e con
+// vibrato, e o procesador completo en cada modo
+void benchCarrier(const Options &options) {
+  const int numBlocks =
+      static_cast<int>(options.seconds * kSampleRate) / kBlockFrames;
+  constexpr int kBands = kVocoderBands;
+  constexpr int kControl = ModulationMatrix::kControlBlock;
+  std::array<float, kBands> freqs;
+  for (int i = 0; i < kBands; i++)
+    freqs[i] = 100.0f * std::pow(140.0f, i / (kBands - 1.0f));
+  std::array<float, kBands> bands{};
+
+  // Vibrato de 5 Hz e +-20 Hz, coma o do procesador
+  auto pitchAt = [](int block, int frame, bool vibrato) {
+    if (!vibrato)
+      return 140.0f;
+    float t = (block * kBlockFrames + frame) / kSampleRate;
+    return 140.0f +
+           20.0f * std::sin(2.0f * static_cast<float>(M_PI) * 5.0f * t);
+  };
+
+  for (bool vibrato : {false, true}) {
+    Oscillator oscillator(kSampleRate);
+    RbjBandpassBank<kBands> bank;
+    for (int i = 0; i < kBands; i++)
+      bank.setBand(i, freqs[i], 12.0f, kSampleRate);
+    Timing filterTiming = timeBlocks(numBlocks, options.repeat, [&](int b) {
+      for (int i = 0; i < kBlockFrames; i++) {
+        oscillator.setFrequency(pitchAt(b, i, vibrato));
+        bank.process(oscillator.process(), bands.data());
+      }
+      gSink = gSink + bands[0];
+    });
+
+    AdditiveCarrier<kBands> additive(kSampleRate);
+    Timing additiveTiming = timeBlocks(numBlocks, options.repeat, [&](int b) {
+      for (int i = 0; i < kBlockFrames; i++) {
+        if (i % kControl == 0)
+          additive.update(pitchAt(b, i, vibrato), freqs.data(), 12.0f);
+        additive.process(bands.data());
+      }
+      gSink = gSink + bands[0];
+    });
+
+    std::printf("carrier%s\n", vibrato ? " (vibrato)" : "");
+    report("  saw + filter bank", filterTiming);
+    report("  additive", additiveTiming);
+  }
+
+  std::vector<float> input =
+      makeSpeechLike(numBlocks * kBlockFrames + kBlockFrames);
+  std::vector<float> output(kBlockFrames * VocoderProcessor::kOutputChannels);
+  struct Case {
+    const char *name;
+    bool additive;
+    bool vibrato;
+  };
+  for (const Case &c : {Case{"processor filter carrier", false, false},
+                        Case{"processor additive", true, false},
+                        Case{"processor filter vibrato", false, true},
+                        Case{"processor additive vibrato", true, true}}) {
+    VocoderProcessor processor(kSampleRate);
+    processor.setAdditive(c.additive);
+    processor.setVibrato(c.vibrato ? 1.0f : 0.0f);
+    Timing timing = timeBlocks(numBlocks, options.repeat, [&](int b) {
+      processor.process(input.data() + b * kBlockFrames, nullptr,
+                        output.data(), kBlockFrames);
+      gSink = gSink + output[0];
+    });
+    report(c.name, timing);
+  }
+}
+
+struct Bench {
+  const char *name;
+  void (*run)(const Options &);
+};
+
+const Bench kBenches[] = {
+    {"stretch", benchStretch},
+    {"stereo", benchStereo},
+    {"banks", benchBanks},
+    {"carrier", benchCarrier},
+};
+
+void usage() {
+  std::fprintf(stderr, "usage: dsp_bench [name ...] [--seconds S] "
+                       "[--repeat N]\nbenchmarks:");
+  for (const Bench &bench : kBenches)
+    std::fprintf(stderr, " %s", bench.name);
+  std::fprintf(stderr, "\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  std::vector<std::string> selected;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+      options.seconds = std::max(0.1f, std::strtof(argv[++i], nullptr));
+    } else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) {
+      options.repeat = std::max(1, std::atoi(argv[++i]));
+    } else if (argv[i][0] == '-') {
+      usage();
+      return 1;
+    } else {
+      selected.emplace_back(argv[i]);
+    }
+  }
+
+  for (const std::string &name : selected) {
+    bool known = false;
+    for (const Bench &bench : kBenches)
+      known = known || name == bench.name;
+    if (!known) {
+      usage();
+      return 1;
+    }
+  }
+
+  for (const Bench &bench : kBenches) {
+    if (selected.empty() ||
+        std::find(selected.begin(), selected.end(), bench.name) !=
+            selected.end()) {
+      bench.run(options);
+    }
+  }
+  return 0;
+}
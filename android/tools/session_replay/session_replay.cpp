@@ -0,0 +1,546 @@
+// Reproduce no host unha sesión capturada co VocoderEngine
+// (startCapture) a través do VocoderProcessor, para perfilar e comparar
+// optimizacións (A/B) coa mesma entrada e os mesmos movementos de mandos.
+//
+//   session_replay sesion.gvs [--output saida.f32] [--compare ref.f32]
+//                             [--tolerance T] [--repeat N]
+//                             [--kernels generic|avx2] [--check-kernels]
+//   session_replay --synthesize sesion.gvs
+//
+// A saída é estéreo intercalado en float32 cru. --compare indica se é
+// idéntica bit a bit a outra saída (p.ex. da versión anterior) ou, con
+// --tolerance, se ningunha mostra se afasta máis de T (para referencias
+// xeradas con outro compilador). --kernels escolle a variante dos kernels
+// DSP (por defecto a xenérica, para que as saídas se poidan comparar entre
+// máquinas); --check-kernels comproba que todas as que admite a CPU dan a
+// mesma saída bit a bit ca xenérica.
+//
+// --synthesize escribe unha sesión sintética, sen dispositivo: a de
+// fixtures/ xerouse así e fixtures/synthetic.f32 é a súa saída de
+// referencia.
+
+#include "SessionFormat.h"
+#include "VocoderProcessor.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Event {
+  session::Tag tag;
+  uint64_t frame;
+  ParamChange change;           // Param
+  session::SessionBlock block;  // Block
+  size_t inputOffset;           // Block: índice en Session::input
+};
+
+struct Session {
+  session::SessionHeader header;
+  std::vector<Event> events;
+  std::vector<float> input;
+  std::map<uint32_t, std::vector<int16_t>> carriers;
+  uint64_t totalFrames = 0;
+  uint32_t droppedRecords = 0;
+  int numParams = 0;
+};
+
+bool readFile(const char *path, std::vector<uint8_t> &data) {
+  FILE *file = std::fopen(path, "rb");
+  if (file == nullptr)
+    return false;
+  std::fseek(file, 0, SEEK_END);
+  long size = std::ftell(file);
+  std::fseek(file, 0, SEEK_SET);
+  data.resize(size > 0 ? size : 0);
+  size_t read = std::fread(data.data(), 1, data.size(), file);
+  std::fclose(file);
+  return read == data.size();
+}
+
+// Le sizeof(T) bytes desde pos se hai datos abondo
+template <typename T>
+bool take(const std::vector<uint8_t> &data, size_t &pos, T &out) {
+  if (data.size() - pos < sizeof(T))
+    return false;
+  std::memcpy(&out, data.data() + pos, sizeof(T));
+  pos += sizeof(T);
+  return true;
+}
+
+bool loadSession(const char *path, Session &session) {
+  std::vector<uint8_t> data;
+  if (!readFile(path, data)) {
+    std::fprintf(stderr, "Cannot read %s\n", path);
+    return false;
+  }
+
+  size_t pos = 0;
+  if (!take(data, pos, session.header) ||
+      std::memcmp(session.header.magic, session::kMagic, 4) != 0 ||
+      session.header.version != session::kVersion) {
+    std::fprintf(stderr, "%s is not a version %u session file\n", path,
+                 session::kVersion);
+    return false;
+  }
+
+  uint8_t tag;
+  while (take(data, pos, tag)) {
+    Event event{};
+    event.tag = static_cast<session::Tag>(tag);
+    switch (event.tag) {
+    case session::Tag::Block: {
+      if (!take(data, pos, event.block))
+        return false;
+      size_t bytes = event.block.numFrames * sizeof(float);
+      if (data.size() - pos < bytes)
+        return false;
+      event.frame = event.block.frame;
+      event.inputOffset = session.input.size();
+      session.input.resize(session.input.size() + event.block.numFrames);
+      std::memcpy(session.input.data() + event.inputOffset, data.data() + pos,
+                  bytes);
+      pos += bytes;
+      session.totalFrames += event.block.numFrames;
+      session.events.push_back(event);
+      break;
+    }
+    case session::Tag::Param: {
+      session::SessionParam record;
+      if (!take(data, pos, record))
+        return false;
+      event.frame = record.frame;
+      event.change = record.change;
+      session.numParams++;
+      session.events.push_back(event);
+      break;
+    }
+    case session::Tag::Carrier: {
+      session::SessionCarrier record;
+      if (!take(data, pos, record))
+        return false;
+      size_t bytes = record.numSamples * sizeof(int16_t);
+      if (data.size() - pos < bytes)
+        return false;
+      auto &samples = session.carriers[record.id];
+      samples.resize(record.numSamples);
+      std::memcpy(samples.data(), data.data() + pos, bytes);
+      pos += bytes;
+      break;
+    }
+    case session::Tag::Gap: {
+      session::SessionGap record;
+      if (!take(data, pos, record))
+        return false;
+      session.droppedRecords += record.droppedRecords;
+      std::fprintf(stderr,
+                   "Warning: %u records lost near frame %llu; the capture "
+                   "is not an exact copy of the device run\n",
+                   record.droppedRecords,
+                   static_cast<unsigned long long>(record.frame));
+      break;
+    }
+    default:
+      std::fprintf(stderr, "Unknown record tag %u at byte %zu\n", tag, pos - 1);
+      return false;
+    }
+  }
+  return true;
+}
+
+// Unha pasada completa cun procesador novo. Devolve os ns de proceso.
+double replay(const Session &session, KernelVariant kernels,
+              std::vector<float> &output) {
+  VocoderProcessor processor(session.header.sampleRate);
+  processor.setKernelVariant(kernels);
+  SampleReader carrierReader;
+  uint32_t currentCarrier = 0;
+
+  output.assign(session.totalFrames * VocoderProcessor::kOutputChannels, 0.0f);
+  float *out = output.data();
+  double ns = 0.0;
+
+  for (const Event &event : session.events) {
+    if (event.tag == session::Tag::Param) {
+      applyParamChange(processor, event.change);
+      continue;
+    }
+
+    const session::SessionBlock &block = event.block;
+    SampleReader *extCarrier = nullptr;
+    if (block.flags & session::kBlockExtCarrier) {
+      auto it = session.carriers.find(block.carrierId);
+      if (it != session.carriers.end()) {
+        if (block.carrierId != currentCarrier) {
+          carrierReader.setSource(it->second.data(),
+                                  static_cast<int32_t>(it->second.size()));
+          currentCarrier = block.carrierId;
+        }
+        carrierReader.setPosition(block.carrierPosition);
+        extCarrier = &carrierReader;
+      }
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    processor.process(session.input.data() + event.inputOffset, extCarrier,
+                      out, static_cast<int>(block.numFrames));
+    auto t1 = std::chrono::steady_clock::now();
+    ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+    out += block.numFrames * VocoderProcessor::kOutputChannels;
+  }
+  return ns;
+}
+
+bool writeOutput(const char *path, const std::vector<float> &output) {
+  FILE *file = std::fopen(path, "wb");
+  if (file == nullptr)
+    return false;
+  size_t written = std::fwrite(output.data(), sizeof(float), output.size(), file);
+  std::fclose(file);
+  return written == output.size();
+}
+
+bool compareOutput(const char *path, const std::vector<float> &output,
+                   float tolerance) {
+  std::vector<uint8_t> data;
+  if (!readFile(path, data)) {
+    std::fprintf(stderr, "Cannot read %s\n", path);
+    return false;
+  }
+  size_t count = std::min(data.size() / sizeof(float), output.size());
+  std::vector<float> reference(count);
+  std::memcpy(reference.data(), data.data(), count * sizeof(float));
+
+  size_t firstDiff = count;
+  size_t outside = 0; // Mostras fóra da tolerancia, NaN incluídos
+  float maxDiff = 0.0f;
+  for (size_t i = 0; i < count; i++) {
+    float diff = std::abs(output[i] - reference[i]);
+    if (std::memcmp(&output[i], &reference[i], sizeof(float)) != 0 &&
+        firstDiff == count)
+      firstDiff = i;
+    if (!(diff <= tolerance))
+      outside++;
+    maxDiff = std::max(maxDiff, diff);
+  }
+
+  bool sameLength = data.size() == output.size() * sizeof(float);
+  if (firstDiff == count && sameLength) {
+    std::printf("compare: bit-identical to %s\n", path);
+    return true;
+  }
+  if (tolerance > 0.0f && sameLength && outside == 0) {
+    std::printf("compare: within %g of %s (max abs diff %g)\n", tolerance,
+                path, maxDiff);
+    return true;
+  }
+  std::printf("compare: DIFFERENT from %s (max abs diff %g", path, maxDiff);
+  if (firstDiff < count)
+    std::printf(", first at frame %zu",
+                firstDiff / VocoderProcessor::kOutputChannels);
+  if (tolerance > 0.0f)
+    std::printf(", %zu samples over %g", outside, tolerance);
+  if (!sameLength)
+    std::printf(", length %zu vs %zu samples", data.size() / sizeof(float),
+                output.size());
+  std::printf(")\n");
+  return false;
+}
+
+// Sesión sintética: 0.5 s de voz artificial (tren de pulsos que sobe de
+// 110 a 180 Hz, dous formantes e sílabas a 4 Hz) mentres se percorren os
+// modos do procesador: estéreo e eco, formante, matriz de modulación,
+// carrier externo, seguimento de pitch co carrier aditivo, LPC e trémolo.
+// Xérase como no motor: un procesador propio aplica os cambios e fai
+// avanzar o lector do carrier, e cada bloque garda a posición que tiña ao
+// comezo. Os bloques teñen tamaños distintos, como os callbacks
+bool synthesizeSession(const char *path) {
+  constexpr float kSampleRate = 48000.0f;
+  constexpr int kFrames = 24000;
+  constexpr int kBlockSizes[] = {256, 192, 480, 96};
+  constexpr uint32_t kCarrierId = 1;
+  constexpr uint64_t kCarrierStart = 9600; // Carrier externo: 0.2-0.3 s
+  constexpr uint64_t kCarrierEnd = 14400;
+
+  // Modulador
+  std::vector<float> input(kFrames);
+  BandpassFilter formant1;
+  BandpassFilter formant2;
+  formant1.setCoefficients(700.0f, 5.0f, kSampleRate);
+  formant2.setCoefficients(1200.0f, 6.0f, kSampleRate);
+  uint32_t noise = 1;
+  double phase = 0.0;
+  for (int i = 0; i < kFrames; i++) {
+    double t = i / kSampleRate;
+    phase += (110.0 + 140.0 * t) / kSampleRate;
+    phase -= std::floor(phase);
+    float pulse = static_cast<float>(2.0 * phase - 1.0);
+    float voice = formant1.process(pulse) + 0.6f * formant2.process(pulse);
+    float syllable = static_cast<float>(0.5 - 0.5 * std::cos(8.0 * M_PI * t));
+    noise = noise * 1664525u + 1013904223u;
+    float hiss = (static_cast<int32_t>(noise) * (1.0f / 2147483648.0f));
+    input[i] = 0.2f * (voice * syllable + 0.02f * hiss);
+  }
+
+  // Carrier externo: acorde de tres serras, 0.25 s en bucle
+  std::vector<int16_t> carrier(12000);
+  for (size_t i = 0; i < carrier.size(); i++) {
+    float sum = 0.0f;
+    for (float freq : {220.0f, 277.2f, 329.6f}) {
+      double cycles = freq * i / kSampleRate;
+      sum += static_cast<float>(2.0 * (cycles - std::floor(cycles)) - 1.0);
+    }
+    carrier[i] = static_cast<int16_t>(sum * 0.25f * 32767.0f);
+  }
+
+  // Cambios de parámetro: os de frame 0 son o snapshot inicial
+  struct Change {
+    uint64_t frame;
+    ParamChange change;
+  };
+  const std::vector<Change> changes = {
+      {0, {ParamId::Pitch, 0, 0, 0, 120.0f}},
+      {0, {ParamId::Intensity, 0, 0, 0, 1.2f}},
+      {0, {ParamId::Waveform, 0, 0, 0, 0.0f}},
+      {0, {ParamId::Vibrato, 0, 0, 0, 0.3f}},
+      {0, {ParamId::NoiseThreshold, 0, 0, 0, 0.01f}},
+      {2400, {ParamId::Stereo, 0, 1, 0, 0.0f}},
+      {2400, {ParamId::Echo, 0, 0, 0, 0.4f}},
+      {4800, {ParamId::Formant, 0, 0, 0, 4.0f}},
+      {4800, {ParamId::StereoWidth, 0, 0, 0, 1.0f}},
+      {7200, {ParamId::ModLfo, 2, 3, 0, 8.0f}},
+      {7200, {ParamId::ModSlot, 0, 2, 0, 0.5f}},
+      {14400, {ParamId::PitchFollow, 0, 1, 0, 0.0f}},
+      {14400, {ParamId::PitchScale, 0, 2, 0, 0.0f}},
+      {14400, {ParamId::Additive, 0, 1, 0, 0.0f}},
+      {18240, {ParamId::Engine, 0, 1, 0, 0.0f}},
+      {18240, {ParamId::Tremolo, 0, 0, 0, 0.5f}},
+      {18240, {ParamId::Stereo, 0, 0, 0, 0.0f}},
+      {21600, {ParamId::Engine, 0, 0, 0, 0.0f}},
+      {21600, {ParamId::Additive, 0, 0, 0, 0.0f}},
+      {21600, {ParamId::Echo, 0, 0, 0, 0.0f}},
+  };
+
+  FILE *file = std::fopen(path, "wb");
+  if (file == nullptr) {
+    std::fprintf(stderr, "Cannot write %s\n", path);
+    return false;
+  }
+  bool ok = true;
+  auto write = [&](const void *data, size_t bytes) {
+    ok = ok && std::fwrite(data, 1, bytes, file) == bytes;
+  };
+  auto writeTag = [&](session::Tag tag) { write(&tag, 1); };
+
+  session::SessionHeader header{};
+  std::memcpy(header.magic, session::kMagic, sizeof(header.magic));
+  header.version = session::kVersion;
+  header.sampleRate = kSampleRate;
+  header.numBands = VocoderProcessor::kNumBands;
+  std::strncpy(header.filterName, VocoderProcessor::getFilterName(),
+               sizeof(header.filterName) - 1);
+  write(&header, sizeof(header));
+
+  session::SessionCarrier carrierRecord{
+      kCarrierId, static_cast<uint32_t>(carrier.size())};
+  writeTag(session::Tag::Carrier);
+  write(&carrierRecord, sizeof(carrierRecord));
+  write(carrier.data(), carrier.size() * sizeof(int16_t));
+
+  VocoderProcessor processor(kSampleRate);
+  SampleReader carrierReader;
+  carrierReader.setSource(carrier.data(), static_cast<int32_t>(carrier.size()));
+  std::vector<float> output(VocoderProcessor::kMaxBlockFrames * 2 *
+                            VocoderProcessor::kOutputChannels);
+  size_t next = 0;
+  uint64_t frame = 0;
+  for (int block = 0; frame < kFrames; block++) {
+    uint32_t numFrames = std::min<uint32_t>(
+        kBlockSizes[block % std::size(kBlockSizes)], kFrames - frame);
+    for (; next < changes.size() && changes[next].frame <= frame; next++) {
+      session::SessionParam record{frame, changes[next].change};
+      writeTag(session::Tag::Param);
+      write(&record, sizeof(record));
+      applyParamChange(processor, changes[next].change);
+    }
+
+    bool ext = frame >= kCarrierStart && frame < kCarrierEnd;
+    session::SessionBlock record{};
+    record.frame = frame;
+    record.numFrames = numFrames;
+    record.flags = ext ? session::kBlockExtCarrier : 0;
+    record.carrierId = kCarrierId;
+    record.carrierPosition = carrierReader.getPosition();
+    writeTag(session::Tag::Block);
+    write(&record, sizeof(record));
+    write(input.data() + frame, numFrames * sizeof(float));
+
+    processor.process(input.data() + frame, ext ? &carrierReader : nullptr,
+                      output.data(), static_cast<int>(numFrames));
+    frame += numFrames;
+  }
+
+  if (std::fclose(file) != 0)
+    ok = false;
+  if (!ok) {
+    std::fprintf(stderr, "Cannot write %s\n", path);
+    return false;
+  }
+  std::printf("synthesized %s: %.2f s, %zu parameter changes\n", path,
+              kFrames / kSampleRate, changes.size());
+  return true;
+}
+
+// Cada variante dispoñible fronte á xenérica
+bool checkKernels(const Session &session) {
+  std::vector<float> reference;
+  replay(session, KernelVariant::Generic, reference);
+  bool ok = true;
+  for (int i = 1; i < static_cast<int>(KernelVariant::Count); i++) {
+    auto variant = static_cast<KernelVariant>(i);
+    if (!isKernelVariantSupported(variant)) {
+      std::printf("kernels %s: not supported on this CPU, skipped\n",
+                  kernelVariantName(variant));
+      continue;
+    }
+    std::vector<float> output;
+    replay(session, variant, output);
+    size_t mismatches = 0;
+    size_t first = 0;
+    float maxDiff = 0.0f;
+    for (size_t n = 0; n < output.size(); n++) {
+      if (std::memcmp(&output[n], &reference[n], sizeof(float)) == 0)
+        continue;
+      if (mismatches++ == 0)
+        first = n;
+      maxDiff = std::max(maxDiff, std::abs(output[n] - reference[n]));
+    }
+    if (mismatches == 0) {
+      std::printf("kernels %s vs generic: bit-identical (ok)\n",
+                  kernelVariantName(variant));
+    } else {
+      std::printf("kernels %s vs generic: %zu of %zu samples differ, first "
+                  "at frame %zu, max abs diff %g (FAIL)\n",
+                  kernelVariantName(variant), mismatches, output.size(),
+                  first / VocoderProcessor::kOutputChannels, maxDiff);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+void usage() {
+  std::fprintf(stderr, "usage: session_replay <session.gvs> [--output out.f32] "
+                       "[--compare ref.f32] [--tolerance T] [--repeat N] "
+                       "[--kernels generic|avx2] [--check-kernels]\n"
+                       "       session_replay --synthesize <session.gvs>\n");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    usage();
+    return 2;
+  }
+  if (std::strcmp(argv[1], "--synthesize") == 0) {
+    if (argc != 3) {
+      usage();
+      return 2;
+    }
+    return synthesizeSession(argv[2]) ? 0 : 1;
+  }
+  const char *sessionPath = argv[1];
+  const char *outputPath = nullptr;
+  const char *comparePath = nullptr;
+  float tolerance = 0.0f;
+  int repeat = 1;
+  KernelVariant kernels = KernelVariant::Generic;
+  bool checkAllKernels = false;
+  for (int i = 2; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--output" && i + 1 < argc) {
+      outputPath = argv[++i];
+    } else if (arg == "--compare" && i + 1 < argc) {
+      comparePath = argv[++i];
+    } else if (arg == "--tolerance" && i + 1 < argc) {
+      tolerance = std::max(0.0f, std::strtof(argv[++i], nullptr));
+    } else if (arg == "--repeat" && i + 1 < argc) {
+      repeat = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--kernels" && i + 1 < argc) {
+      int variant = kernelVariantFromName(argv[++i]);
+      if (variant < 0 ||
+          !isKernelVariantSupported(static_cast<KernelVariant>(variant))) {
+        std::fprintf(stderr, "Kernel variant '%s' not available here\n",
+                     argv[i]);
+        return 2;
+      }
+      kernels = static_cast<KernelVariant>(variant);
+    } else if (arg == "--check-kernels") {
+      checkAllKernels = true;
+    } else {
+      usage();
+      return 2;
+    }
+  }
+
+  Session session;
+  if (!loadSession(sessionPath, session))
+    return 1;
+
+  const float sampleRate = session.header.sampleRate;
+  std::printf("session: %.2f s @ %.0f Hz, %d parameter changes, %zu "
+              "carrier(s), recorded with '%s'\n",
+              session.totalFrames / sampleRate, sampleRate, session.numParams,
+              session.carriers.size(), session.header.filterName);
+  if (session.header.numBands != VocoderProcessor::kNumBands) {
+    std::fprintf(stderr, "Session has %u bands, this build has %d\n",
+                 session.header.numBands, VocoderProcessor::kNumBands);
+    return 1;
+  }
+  std::printf("replaying with '%s', %s kernels\n",
+              VocoderProcessor::getFilterName(), kernelVariantName(kernels));
+
+  // Cada pasada parte dun procesador novo: todas deben dar a mesma saída
+  std::vector<float> output;
+  std::vector<float> previous;
+  double best = 0.0;
+  double total = 0.0;
+  bool deterministic = true;
+  for (int i = 0; i < repeat; i++) {
+    double ns = replay(session, kernels, output);
+    best = (i == 0) ? ns : std::min(best, ns);
+    total += ns;
+    if (i > 0 && std::memcmp(previous.data(), output.data(),
+                             output.size() * sizeof(float)) != 0)
+      deterministic = false;
+    previous.swap(output);
+  }
+  output.swap(previous);
+
+  double audioNs = session.totalFrames * 1.0e9 / sampleRate;
+  std::printf("process: best %.3f ms, mean %.3f ms over %d run(s), "
+              "%.1f ns/frame, %.2f%% of real time\n",
+              best / 1.0e6, total / repeat / 1.0e6, repeat,
+              best / std::max<uint64_t>(session.totalFrames, 1),
+              100.0 * best / std::max(audioNs, 1.0));
+  if (!deterministic) {
+    std::printf("WARNING: replay runs produced different output\n");
+  }
+
+  if (outputPath != nullptr && !writeOutput(outputPath, output)) {
+    std::fprintf(stderr, "Cannot write %s\n", outputPath);
+    return 1;
+  }
+  if (comparePath != nullptr && !compareOutput(comparePath, output, tolerance))
+    return 3;
+  if (checkAllKernels && !checkKernels(session))
+    return 5;
+  return deterministic ? 0 : 4;
+}
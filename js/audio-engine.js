@@ -2,6 +2,11 @@
  * VocoderEngine - Implements a real-time vocoder using the Web Audio API
  * The vocoder works by analyzing the input signal (modulator) and using it to control 
  * the amplitude of different frequency bands in a carrier signal (oscillator).
+ *
+ * When AudioWorklet and the WebAssembly core (js/vocoder-core.wasm, built from
+ * wasm/) are available, the whole vocoder runs in a single worklet node with
+ * the same C++ DSP as the Android app; otherwise it falls back to the
+ * BiquadFilterNode graph (setupGraph).
  */
 class VocoderEngine {
     /**
@@ -29,6 +34,28 @@ class VocoderEngine {
         this.fileBuffer = null;
         this.fileSource = null;
         this.preAmp = null;
+
+        // Núcleo WASM: nodo do worklet e anel de parámetros compartido
+        this.vocoderNode = null;
+        this.paramRing = null;
+        this.pendingParams = new Map();
+
+        // Motor en uso ('wasm' ou 'graph') e por que non é o núcleo WASM;
+        // onCoreStatus(status, reason) avisa á UI de cada cambio
+        this.coreStatus = null;
+        this.coreFallbackReason = null;
+        this.onCoreStatus = null;
+    }
+
+    /**
+     * Records which vocoder implementation is running and notifies the UI
+     * @param {'wasm'|'graph'} status - WASM core or BiquadFilterNode graph
+     * @param {string|null} reason - Why the WASM core is not in use
+     */
+    setCoreStatus(status, reason) {
+        this.coreStatus = status;
+        this.coreFallbackReason = reason;
+        if (this.onCoreStatus) this.onCoreStatus(status, reason);
     }
 
     /**
@@ -67,7 +94,17 @@ class VocoderEngine {
         this.analyser = this.ctx.createAnalyser();
         this.analyser.fftSize = CONSTANTS.FFT_SIZE;
 
-        this.setupGraph();
+        try {
+            await this.setupWorklet();
+            this.setCoreStatus('wasm', null);
+        } catch (e) {
+            // Sen AudioWorklet ou sen o .wasm (p.ex. aberto desde file://
+            // ou sen compilar: wasm/build.sh)
+            console.warn('[VOCODER] WASM core unavailable, using the Web Audio graph ' +
+                '(build js/vocoder-core.wasm with wasm/build.sh):', e);
+            this.setupGraph();
+            this.setCoreStatus('graph', e.message || String(e));
+        }
         this.masterOut.connect(this.limiter);
         this.limiter.connect(this.analyser);
         this.analyser.connect(this.ctx.destination);
@@ -151,6 +188,111 @@ class VocoderEngine {
         this.carrier.start();
     }
 
+    /**
+     * Sets up the vocoder as a single AudioWorklet node running the C++ core
+     * compiled to WebAssembly: inputCompressor -> worklet -> masterOut
+     * @returns {Promise<void>} Rejects if AudioWorklet or the core is unavailable
+     */
+    async setupWorklet() {
+        // Estado dun contexto anterior (create() volve crealo todo)
+        this.vocoderNode = null;
+        this.paramRing = null;
+        this.pendingParams.clear();
+        if (!this.ctx.audioWorklet || typeof WebAssembly === 'undefined') {
+            throw new Error('AudioWorklet/WebAssembly not supported');
+        }
+        const { ParamRing, ParamId, WAVEFORMS } = await import('./vocoder-core.mjs');
+        this.coreParamIds = ParamId;
+        this.coreWaveforms = WAVEFORMS;
+        const response = await fetch(CONSTANTS.WASM_CORE_URL);
+        if (!response.ok) throw new Error(`${CONSTANTS.WASM_CORE_URL}: HTTP ${response.status}`);
+        const [module] = await Promise.all([
+            WebAssembly.compile(await response.arrayBuffer()),
+            this.ctx.audioWorklet.addModule(CONSTANTS.WORKLET_URL)
+        ]);
+
+        // SharedArrayBuffer só existe con illamento de orixe (COOP/COEP);
+        // sen el os cambios van polo porto do nodo
+        let ring = null;
+        if (typeof SharedArrayBuffer !== 'undefined' && self.crossOriginIsolated) {
+            ring = ParamRing.createBuffer(CONSTANTS.PARAM_RING_CAPACITY);
+            this.paramRing = new ParamRing(ring);
+        }
+
+        this.vocoderNode = new AudioWorkletNode(this.ctx, 'vocoder-processor', {
+            numberOfInputs: 1,
+            numberOfOutputs: 1,
+            outputChannelCount: [2],
+            channelCount: 1,
+            channelCountMode: 'explicit',
+            processorOptions: { module, ring }
+        });
+        this.vocoderNode.onprocessorerror = (e) => {
+            console.error('[VOCODER] WASM core failed, switching to the Web Audio graph:', e);
+            this.teardownWorklet();
+            this.setupGraph();
+            this.setCoreStatus('graph', 'processor error');
+        };
+        this.inputCompressor.connect(this.vocoderNode);
+        this.vocoderNode.connect(this.masterOut);
+        this.sendParams(this.params);
+        console.log('[VOCODER] WASM core active', ring ? '(shared parameter ring)' : '(message port)');
+    }
+
+    /**
+     * Disconnects the worklet node (after a processor error)
+     */
+    teardownWorklet() {
+        if (!this.vocoderNode) return;
+        try { this.inputCompressor.disconnect(this.vocoderNode); } catch (e) { }
+        this.vocoderNode.disconnect();
+        this.vocoderNode = null;
+        this.paramRing = null;
+        this.pendingParams.clear();
+    }
+
+    /**
+     * Queues a parameter change for the WASM core (same fields as ParamChange)
+     */
+    postParam(id, index, a, b, value) {
+        if (!this.paramRing) {
+            this.vocoderNode.port.postMessage([id, index, a, b, value]);
+            return;
+        }
+        this.flushPendingParams();
+        if (!this.paramRing.push(id, index, a, b, value)) {
+            // Anel cheo (contexto suspendido): quedar co último valor
+            this.pendingParams.set(`${id}:${index}`, [id, index, a, b, value]);
+        }
+    }
+
+    /**
+     * Retries the changes that did not fit in the ring, oldest first
+     */
+    flushPendingParams() {
+        for (const [key, change] of this.pendingParams) {
+            if (!this.paramRing.push(change[0], change[1], change[2], change[3], change[4])) return;
+            this.pendingParams.delete(key);
+        }
+    }
+
+    /**
+     * Sends the given parameters to the WASM core, with the same ranges the
+     * Android app uses
+     * @param {Object} p - Parameters (pitch, intensity, vibrato, tremolo, echo, wave)
+     */
+    sendParams(p) {
+        const ids = this.coreParamIds;
+        if (Number.isFinite(p.pitch)) this.postParam(ids.PITCH, 0, 0, 0, Number(p.pitch));
+        if (Number.isFinite(p.intensity)) this.postParam(ids.INTENSITY, 0, 0, 0, Number(p.intensity));
+        if (Number.isFinite(p.vibrato)) this.postParam(ids.VIBRATO, 0, 0, 0, Number(p.vibrato));
+        if (Number.isFinite(p.tremolo)) this.postParam(ids.TREMOLO, 0, 0, 0, Number(p.tremolo));
+        if (Number.isFinite(p.echo)) this.postParam(ids.ECHO, 0, 0, 0, Number(p.echo));
+        if (p.wave && p.wave in this.coreWaveforms) {
+            this.postParam(ids.WAVEFORM, 0, this.coreWaveforms[p.wave], 0, 0);
+        }
+    }
+
     /**
      * Toggles the microphone input on or off
      * @param {boolean} active - Whether to activate or deactivate the microphone
@@ -244,9 +386,14 @@ class VocoderEngine {
                     'intensity:', this.params.intensity);
             }
 
+            // Cambios que non couberon no anel mentres o contexto estaba parado
+            if (this.paramRing && this.pendingParams.size > 0) {
+                this.flushPendingParams();
+            }
+
             const now = this.ctx.currentTime;
 
-            // Process each frequency band
+            // Process each frequency band (só no grafo Web Audio)
             const bandLevels = [];
             this.filterNodes.forEach((band, index) => {
                 const bandData = new Uint8Array(band.modAnalyser.frequencyBinCount);
@@ -276,7 +423,7 @@ class VocoderEngine {
             });
 
             // Debug: mostrar niveles de varias bandas cada segundo
-            if (debugCounter % 60 === 0 && this.modLevel > this.noiseThreshold) {
+            if (debugCounter % 60 === 0 && this.filterNodes.length > 0 && this.modLevel > this.noiseThreshold) {
                 console.log('[BANDS] modLevel:', this.modLevel.toFixed(3), 'Bands:', bandLevels);
             }
 
@@ -293,6 +440,10 @@ class VocoderEngine {
         console.log('[updateParams] Recibido:', p);
         Object.assign(this.params, p);
         if (!this.initialized || !this.ctx) return;
+        if (this.vocoderNode) {
+            this.sendParams(p);
+            return;
+        }
         const now = this.ctx.currentTime;
         if (this.carrier && Number.isFinite(this.params.pitch)) {
             this.carrier.frequency.setTargetAtTime(Number(this.params.pitch), now, 0.05);
@@ -25,6 +25,9 @@ const CONSTANTS = {
     LIMITER_RATIO: 20,
     VIBRATO_FREQ: 6.0,
     ECHO_DELAY: 0.3,
+    WORKLET_URL: 'js/vocoder-worklet.js',
+    WASM_CORE_URL: 'js/vocoder-core.wasm',
+    PARAM_RING_CAPACITY: 1024,
     MAX_RETRY_ATTEMPTS: 5,
     RETRY_DELAY_BASE: 1000,
     MAX_GAIN_MULTIPLIER: 15.0,
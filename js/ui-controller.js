@@ -22,9 +22,25 @@ class UIController {
         this.btnInfo = document.getElementById('btn-info');
         this.btnCloseInfo = document.getElementById('btn-close-info');
 
+        // Núcleo WASM que falla a mitad de sesión: avisar del cambio de motor
+        this.engine.onCoreStatus = (status) => {
+            if (status === 'graph' && this.engine.ctx && this.engine.ctx.state === 'running') {
+                this.msgBox.innerHTML = this.graphFallbackMessage();
+            }
+        };
+
         this.initializeEventListeners();
     }
 
+    /**
+     * Message shown while the Web Audio graph replaces the WASM core
+     * @returns {string} HTML for the message box
+     */
+    graphFallbackMessage() {
+        return "<span class='text-red-400'>INDUCCIÓN EN CURSO CON EL MOTOR DE RESERVA " +
+            "(NÚCLEO WASM NO DISPONIBLE)</span>";
+    }
+
     /**
      * Sets up all event listeners for UI elements
      */
@@ -54,7 +70,11 @@ class UIController {
                 await this.engine.ctx.resume();
                 this.btnPower.innerText = "Cesar Inducción";
                 this.ledPower.classList.add('on');
-                this.msgBox.innerText = "INDUCCIÓN EN CURSO";
+                if (this.engine.coreStatus === 'graph') {
+                    this.msgBox.innerHTML = this.graphFallbackMessage();
+                } else {
+                    this.msgBox.innerText = "INDUCCIÓN EN CURSO";
+                }
                 requestAnimationFrame(updateVU);
                 drawOsc();
             }
@@ -0,0 +1,211 @@
+/**
+ * Shared glue for the WebAssembly build of the C++ vocoder core (wasm/).
+ * Used by the AudioWorklet (vocoder-worklet.js), by the main thread for the
+ * parameter ring and by the Node replay tool (wasm/replay.mjs).
+ */
+
+// Mesma orde que ParamId en android/app/src/main/cpp/ParameterMailbox.h
+export const ParamId = Object.freeze({
+    PITCH: 0,
+    INTENSITY: 1,
+    WAVEFORM: 2, // a = tipo
+    VIBRATO: 3,
+    ECHO: 4,
+    TREMOLO: 5,
+    NOISE_THRESHOLD: 6,
+    FORMANT: 7,
+    STEREO: 8, // a = 0/1
+    STEREO_WIDTH: 9,
+    MOD_SLOT: 10, // index = slot, a = fonte, b = destino, value = depth
+    MOD_LFO: 11, // index = LFO, a = forma, value = Hz
+    PITCH_FOLLOW: 12, // a = 0/1
+    PITCH_INTERVAL: 13,
+    PITCH_SCALE: 14, // a = escala
+    ENGINE: 15, // a = 0 banco de filtros, 1 LPC
+    ADDITIVE: 16, // a = 0/1
+    ADDITIVE_TILT: 17
+});
+
+// Oscillator::Waveform do núcleo, cos nomes de OscillatorNode.type
+export const WAVEFORMS = Object.freeze({ sawtooth: 0, square: 1, triangle: 2, sine: 3 });
+
+export const OUTPUT_CHANNELS = 2;
+
+const WASI_ENOSYS = 52;
+
+/**
+ * Minimal WASI imports for the standalone module: the core only needs a clock
+ * (PitchTracker load meter) and, at most, stdout/stderr.
+ * @param {WebAssembly.Module} module - Compiled core
+ * @param {function(): WebAssembly.Memory} getMemory - Memory of the instance
+ * @returns {Object} Import object for WebAssembly.Instance
+ */
+function buildImports(module, getMemory) {
+    const now = () => (globalThis.performance ? globalThis.performance.now() : Date.now());
+    const wasi = {
+        clock_time_get(id, precision, timePtr) {
+            const view = new DataView(getMemory().buffer);
+            view.setBigUint64(timePtr, BigInt(Math.round(now() * 1e6)), true);
+            return 0;
+        },
+        fd_write(fd, iovs, iovsLen, writtenPtr) {
+            // A saída de texto do núcleo descártase
+            const view = new DataView(getMemory().buffer);
+            let written = 0;
+            for (let i = 0; i < iovsLen; i++) {
+                written += view.getUint32(iovs + i * 8 + 4, true);
+            }
+            view.setUint32(writtenPtr, written, true);
+            return 0;
+        },
+        proc_exit(code) {
+            throw new Error(`vocoder core exited with code ${code}`);
+        }
+    };
+
+    const imports = {};
+    for (const entry of WebAssembly.Module.imports(module)) {
+        if (entry.kind !== 'function') continue;
+        imports[entry.module] = imports[entry.module] || {};
+        const known = entry.module === 'wasi_snapshot_preview1' ? wasi[entry.name] : undefined;
+        imports[entry.module][entry.name] = known || (() => WASI_ENOSYS);
+    }
+    return imports;
+}
+
+/**
+ * One VocoderProcessor inside its own WebAssembly instance.
+ * Write the modulator to `input`, call process() and read the interleaved
+ * stereo result from `output`.
+ */
+export class VocoderCore {
+    /**
+     * @param {WebAssembly.Module} module - Compiled js/vocoder-core.wasm
+     * @param {number} sampleRate - Sample rate in Hz
+     */
+    constructor(module, sampleRate) {
+        let memory = null;
+        const instance = new WebAssembly.Instance(module, buildImports(module, () => memory));
+        this.exports = instance.exports;
+        memory = this.exports.memory;
+        this.memory = memory;
+
+        // Módulo "reactor": construtores estáticos antes da primeira chamada
+        if (this.exports._initialize) this.exports._initialize();
+        this.exports.vocoder_create(sampleRate);
+        this.maxFrames = this.exports.vocoder_max_frames();
+        this.updateViews();
+    }
+
+    /**
+     * Rebuilds the views over the module memory (needed after it grows,
+     * which only happens when allocating in the constructor or loadCarrier)
+     */
+    updateViews() {
+        const buffer = this.memory.buffer;
+        this.input = new Float32Array(buffer, this.exports.vocoder_input(), this.maxFrames);
+        this.output = new Float32Array(buffer, this.exports.vocoder_output(),
+            this.maxFrames * OUTPUT_CHANNELS);
+    }
+
+    /**
+     * Processes numFrames (<= maxFrames) from `input` into `output`
+     * @param {number} numFrames - Frames to process
+     * @param {boolean} useCarrier - Use the loaded external carrier instead of the oscillator
+     */
+    process(numFrames, useCarrier = false) {
+        this.exports.vocoder_process(numFrames, useCarrier ? 1 : 0);
+    }
+
+    /**
+     * Applies a parameter change (same fields as ParamChange)
+     */
+    setParam(id, index, a, b, value) {
+        this.exports.vocoder_set_param(id, index, a, b, value);
+    }
+
+    /**
+     * Copies an external carrier into the core
+     * @param {Int16Array} samples - Mono 16-bit carrier
+     */
+    loadCarrier(samples) {
+        const ptr = this.exports.vocoder_load_carrier(samples.length);
+        this.updateViews();
+        if (ptr) new Int16Array(this.memory.buffer, ptr, samples.length).set(samples);
+    }
+
+    /**
+     * @param {number} position - Read position of the external carrier, in samples
+     */
+    setCarrierPosition(position) {
+        this.exports.vocoder_set_carrier_position(position);
+    }
+
+    destroy() {
+        this.exports.vocoder_destroy();
+    }
+}
+
+/**
+ * Single-producer/single-consumer ring of parameter changes over a
+ * SharedArrayBuffer: the main thread pushes, the AudioWorklet drains at the
+ * start of each render quantum without locks or allocations.
+ *
+ * Each record takes 8 bytes with the ParamChange layout (id, index, a, b as
+ * bytes, then the float value). The header holds the write and read counters.
+ */
+export class ParamRing {
+    /**
+     * @param {number} capacity - Records, a power of two
+     * @returns {SharedArrayBuffer} Buffer to share with the worklet
+     */
+    static createBuffer(capacity = 1024) {
+        if (capacity <= 0 || (capacity & (capacity - 1)) !== 0) {
+            throw new RangeError('ParamRing capacity must be a power of two');
+        }
+        return new SharedArrayBuffer(8 + capacity * 8);
+    }
+
+    /**
+     * @param {SharedArrayBuffer} buffer - Buffer from createBuffer()
+     */
+    constructor(buffer) {
+        this.buffer = buffer;
+        this.header = new Int32Array(buffer, 0, 2);
+        this.words = new Int32Array(buffer, 8);
+        this.values = new Float32Array(buffer, 8);
+        this.mask = this.words.length / 2 - 1;
+    }
+
+    /**
+     * @returns {boolean} false if the ring is full (the change is not queued)
+     */
+    push(id, index, a, b, value) {
+        const write = Atomics.load(this.header, 0);
+        const read = Atomics.load(this.header, 1);
+        if (((write - read) | 0) > this.mask) return false;
+        const slot = (write & this.mask) * 2;
+        this.words[slot] = (id & 0xff) | ((index & 0xff) << 8) | ((a & 0xff) << 16) | ((b & 0xff) << 24);
+        this.values[slot + 1] = value;
+        Atomics.store(this.header, 0, (write + 1) | 0);
+        return true;
+    }
+
+    /**
+     * Calls fn(id, index, a, b, value) for every queued change, oldest first
+     * @param {function(number, number, number, number, number)} fn - Receiver
+     */
+    drain(fn) {
+        const write = Atomics.load(this.header, 0);
+        let read = Atomics.load(this.header, 1);
+        while (read !== write) {
+            const slot = (read & this.mask) * 2;
+            const packed = this.words[slot];
+            // a e b son int8 con signo
+            fn(packed & 0xff, (packed >> 8) & 0xff, (packed << 8) >> 24, packed >> 24,
+                this.values[slot + 1]);
+            read = (read + 1) | 0;
+        }
+        Atomics.store(this.header, 1, read);
+    }
+}
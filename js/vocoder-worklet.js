@@ -0,0 +1,59 @@
+/**
+ * AudioWorklet processor that runs the C++ vocoder core (WebAssembly).
+ * Mono modulator in, stereo vocoder out. Parameter changes arrive through a
+ * ParamRing when SharedArrayBuffer is available, or as messages otherwise,
+ * and are applied at the start of each render quantum.
+ */
+import { ParamRing, VocoderCore } from './vocoder-core.mjs';
+
+class VocoderWorkletProcessor extends AudioWorkletProcessor {
+    /**
+     * @param {Object} options - processorOptions: { module: WebAssembly.Module, ring: SharedArrayBuffer|null }
+     */
+    constructor(options) {
+        super();
+        const { module, ring } = options.processorOptions;
+        this.core = new VocoderCore(module, sampleRate);
+        this.ring = ring ? new ParamRing(ring) : null;
+        this.queued = [];
+        this.port.onmessage = (event) => {
+            this.queued.push(event.data);
+        };
+        this.applyParam = (id, index, a, b, value) => this.core.setParam(id, index, a, b, value);
+    }
+
+    process(inputs, outputs) {
+        if (this.ring) this.ring.drain(this.applyParam);
+        if (this.queued.length > 0) {
+            for (let i = 0; i < this.queued.length; i++) {
+                const change = this.queued[i]; // [id, index, a, b, value]
+                this.applyParam(change[0], change[1], change[2], change[3], change[4]);
+            }
+            this.queued.length = 0;
+        }
+
+        const output = outputs[0];
+        const left = output[0];
+        const right = output.length > 1 ? output[1] : null;
+        const frames = Math.min(left.length, this.core.maxFrames);
+
+        // Sen fonte conectada a entrada chega baleira: procesar silencio
+        const input = inputs[0] && inputs[0].length > 0 ? inputs[0][0] : null;
+        if (input) {
+            this.core.input.set(input.subarray(0, frames));
+        } else {
+            this.core.input.fill(0, 0, frames);
+        }
+
+        this.core.process(frames);
+
+        const stereo = this.core.output;
+        for (let i = 0; i < frames; i++) {
+            left[i] = stereo[2 * i];
+            if (right) right[i] = stereo[2 * i + 1];
+        }
+        return true;
+    }
+}
+
+registerProcessor('vocoder-processor', VocoderWorkletProcessor);
@@ -0,0 +1,41 @@
+#!/bin/sh
+# Compila o núcleo WebAssembly (js/vocoder-core.wasm) con Emscripten e
+# compróbao contra o host: a mesma sesión polo session_replay (kernels
+# xenéricos) e por wasm/replay.mjs, mostra a mostra coa tolerancia de
+# replay.mjs. Sen argumentos usa a sesión sintética de
+# android/tools/session_replay/fixtures, que ademais se compara coa súa
+# saída de referencia.
+#
+#   wasm/build.sh [sesion.gvs]
+#
+# Precisa emcmake no PATH (emsdk activado), node e un compilador de C++
+# para o host. Sae con erro se algo falla.
+set -e
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+BUILD="$ROOT/build-wasm"
+REPLAY_BUILD="$ROOT/android/build-replay"
+FIXTURES="$ROOT/android/tools/session_replay/fixtures"
+TOLERANCE=2e-3
+
+if ! command -v emcmake >/dev/null 2>&1; then
+    echo "emcmake not found: install and activate emsdk (https://emscripten.org)" >&2
+    exit 1
+fi
+
+emcmake cmake -S "$ROOT/wasm" -B "$BUILD" -DCMAKE_BUILD_TYPE=Release
+cmake --build "$BUILD"
+echo "built $ROOT/js/vocoder-core.wasm"
+
+SESSION=${1:-"$FIXTURES/synthetic.gvs"}
+cmake -S "$ROOT/android/tools/session_replay" -B "$REPLAY_BUILD" \
+    -DCMAKE_BUILD_TYPE=Release
+cmake --build "$REPLAY_BUILD"
+if [ -z "$1" ]; then
+    "$REPLAY_BUILD/session_replay" "$SESSION" --kernels generic \
+        --compare "$FIXTURES/synthetic.f32" --tolerance "$TOLERANCE"
+fi
+"$REPLAY_BUILD/session_replay" "$SESSION" --kernels generic \
+    --output "$BUILD/host.f32"
+node "$ROOT/wasm/replay.mjs" "$SESSION" --compare "$BUILD/host.f32" \
+    --tolerance "$TOLERANCE"
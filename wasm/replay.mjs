@@ -0,0 +1,233 @@
+// Reproduce en Node unha sesión capturada (.gvs, ver SessionFormat.h) a
+// través do núcleo WebAssembly, co mesmo código que usa o AudioWorklet, e
+// compáraa coa saída do replay do host (tools/session_replay).
+//
+//   node wasm/replay.mjs sesion.gvs [--wasm js/vocoder-core.wasm]
+//                        [--output web.f32] [--compare host.f32]
+//                        [--tolerance T] [--repeat N]
+//
+// A libm de WebAssembly non é a do host, así que a saída non ten por que
+// ser idéntica bit a bit: ningunha mostra pode afastarse da do host máis de
+// T (por defecto 2e-3, o mesmo valor que --tolerance no session_replay para
+// a sesión de android/tools/session_replay/fixtures).
+
+import { existsSync, readFileSync, writeFileSync } from 'node:fs';
+import { performance } from 'node:perf_hooks';
+import { fileURLToPath } from 'node:url';
+import { OUTPUT_CHANNELS, VocoderCore } from '../js/vocoder-core.mjs';
+
+const DEFAULT_TOLERANCE = 2e-3;
+
+const TAG_BLOCK = 1;
+const TAG_PARAM = 2;
+const TAG_CARRIER = 3;
+const TAG_GAP = 4;
+const BLOCK_EXT_CARRIER = 1;
+
+function loadSession(path) {
+    const data = readFileSync(path);
+    const view = new DataView(data.buffer, data.byteOffset, data.byteLength);
+    // Copia aliñada dun tramo do ficheiro
+    const slice = (offset, bytes) => data.buffer.slice(data.byteOffset + offset,
+        data.byteOffset + offset + bytes);
+
+    // SessionHeader: magic[4], version, sampleRate, numBands, filterName[32]
+    if (data.length < 48 || data.toString('latin1', 0, 4) !== 'GVSN' ||
+        view.getUint32(4, true) !== 1) {
+        throw new Error(`${path} is not a version 1 session file`);
+    }
+    const session = {
+        sampleRate: view.getFloat32(8, true),
+        filterName: data.toString('latin1', 16, 48).replace(/\0.*$/s, ''),
+        events: [],
+        carriers: new Map(),
+        totalFrames: 0,
+        numParams: 0
+    };
+
+    let pos = 48;
+    while (pos < data.length) {
+        const tag = view.getUint8(pos++);
+        if (tag === TAG_BLOCK) {
+            // SessionBlock: frame u64, numFrames u32, flags u8, carrierId u32, carrierPosition f64
+            const numFrames = view.getUint32(pos + 8, true);
+            const block = {
+                tag,
+                numFrames,
+                flags: view.getUint8(pos + 12),
+                carrierId: view.getUint32(pos + 13, true),
+                carrierPosition: view.getFloat64(pos + 17, true),
+                input: new Float32Array(slice(pos + 25, numFrames * 4))
+            };
+            pos += 25 + numFrames * 4;
+            session.totalFrames += numFrames;
+            session.events.push(block);
+        } else if (tag === TAG_PARAM) {
+            // SessionParam: frame u64 + ParamChange (id, index, a, b, value)
+            session.events.push({
+                tag,
+                id: view.getUint8(pos + 8),
+                index: view.getUint8(pos + 9),
+                a: view.getInt8(pos + 10),
+                b: view.getInt8(pos + 11),
+                value: view.getFloat32(pos + 12, true)
+            });
+            session.numParams++;
+            pos += 16;
+        } else if (tag === TAG_CARRIER) {
+            const id = view.getUint32(pos, true);
+            const numSamples = view.getUint32(pos + 4, true);
+            session.carriers.set(id, new Int16Array(slice(pos + 8, numSamples * 2)));
+            pos += 8 + numSamples * 2;
+        } else if (tag === TAG_GAP) {
+            console.warn(`Warning: ${view.getUint32(pos + 8, true)} records lost near frame ` +
+                `${view.getBigUint64(pos, true)}; the capture is not an exact copy of the device run`);
+            pos += 12;
+        } else {
+            throw new Error(`Unknown record tag ${tag} at byte ${pos - 1}`);
+        }
+        if (pos > data.length) throw new Error(`${path} is truncated`);
+    }
+    return session;
+}
+
+// Unha pasada completa cunha instancia nova. Devolve os ms de proceso.
+function replay(module, session, output) {
+    const core = new VocoderCore(module, session.sampleRate);
+    let currentCarrier = 0;
+    let out = 0;
+    let ms = 0;
+
+    for (const event of session.events) {
+        if (event.tag === TAG_PARAM) {
+            core.setParam(event.id, event.index, event.a, event.b, event.value);
+            continue;
+        }
+        if (event.numFrames > core.maxFrames) {
+            throw new Error(`Block of ${event.numFrames} frames exceeds the core limit (${core.maxFrames})`);
+        }
+
+        let useCarrier = false;
+        if (event.flags & BLOCK_EXT_CARRIER) {
+            const carrier = session.carriers.get(event.carrierId);
+            if (carrier) {
+                if (event.carrierId !== currentCarrier) {
+                    core.loadCarrier(carrier);
+                    currentCarrier = event.carrierId;
+                }
+                core.setCarrierPosition(event.carrierPosition);
+                useCarrier = true;
+            }
+        }
+
+        core.input.set(event.input);
+        const t0 = performance.now();
+        core.process(event.numFrames, useCarrier);
+        ms += performance.now() - t0;
+        const samples = event.numFrames * OUTPUT_CHANNELS;
+        output.set(core.output.subarray(0, samples), out);
+        out += samples;
+    }
+    core.destroy();
+    return ms;
+}
+
+function compareOutput(path, output, tolerance) {
+    const data = readFileSync(path);
+    const reference = new Float32Array(data.buffer.slice(data.byteOffset,
+        data.byteOffset + (data.byteLength & ~3)));
+    const count = Math.min(reference.length, output.length);
+    const sameLength = reference.length === output.length;
+
+    let identical = sameLength;
+    let maxDiff = 0;
+    let outside = 0;
+    let firstOutside = -1;
+    for (let i = 0; i < count; i++) {
+        if (Object.is(output[i], reference[i])) continue;
+        identical = false;
+        // NaN tamén queda fóra
+        const diff = Math.abs(output[i] - reference[i]);
+        if (!(diff <= tolerance)) {
+            if (outside++ === 0) firstOutside = i;
+        }
+        if (diff > maxDiff) maxDiff = diff;
+    }
+    if (identical) {
+        console.log(`compare: bit-identical to ${path}`);
+        return true;
+    }
+
+    const pass = sameLength && outside === 0;
+    console.log(`compare: max abs diff ${maxDiff.toPrecision(6)} vs ${path}, ` +
+        `${outside} samples over ${tolerance}` +
+        (firstOutside >= 0 ? `, first at frame ${Math.floor(firstOutside / OUTPUT_CHANNELS)}` : '') +
+        (sameLength ? '' : ` (length ${reference.length} vs ${output.length} samples)`) +
+        ` (${pass ? 'ok' : 'FAIL'})`);
+    return pass;
+}
+
+function usage() {
+    console.error('usage: node wasm/replay.mjs <session.gvs> [--wasm core.wasm] ' +
+        '[--output out.f32] [--compare host.f32] [--tolerance T] [--repeat N]');
+}
+
+function main(argv) {
+    if (argv.length < 1) {
+        usage();
+        return 1;
+    }
+    let wasmPath = fileURLToPath(new URL('../js/vocoder-core.wasm', import.meta.url));
+    let outputPath = null;
+    let comparePath = null;
+    let tolerance = DEFAULT_TOLERANCE;
+    let repeat = 1;
+    for (let i = 1; i < argv.length; i++) {
+        const arg = argv[i];
+        if (arg === '--wasm' && i + 1 < argv.length) {
+            wasmPath = argv[++i];
+        } else if (arg === '--output' && i + 1 < argv.length) {
+            outputPath = argv[++i];
+        } else if (arg === '--compare' && i + 1 < argv.length) {
+            comparePath = argv[++i];
+        } else if (arg === '--tolerance' && i + 1 < argv.length) {
+            tolerance = Math.max(0, parseFloat(argv[++i]) || 0);
+        } else if (arg === '--repeat' && i + 1 < argv.length) {
+            repeat = Math.max(1, parseInt(argv[++i], 10) || 1);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    if (!existsSync(wasmPath)) {
+        console.error(`${wasmPath} not found: build it with wasm/build.sh`);
+        return 1;
+    }
+    const session = loadSession(argv[0]);
+    const module = new WebAssembly.Module(readFileSync(wasmPath));
+    const seconds = session.totalFrames / session.sampleRate;
+    console.log(`session: ${seconds.toFixed(2)} s @ ${session.sampleRate} Hz, ` +
+        `${session.numParams} parameter changes, ${session.carriers.size} carrier(s), ` +
+        `recorded with '${session.filterName}'`);
+    console.log(`replaying with ${wasmPath}`);
+
+    const output = new Float32Array(session.totalFrames * OUTPUT_CHANNELS);
+    let best = Infinity;
+    let total = 0;
+    for (let run = 0; run < repeat; run++) {
+        const ms = replay(module, session, output);
+        best = Math.min(best, ms);
+        total += ms;
+    }
+    const nsPerFrame = best * 1e6 / Math.max(1, session.totalFrames);
+    console.log(`process: best ${best.toFixed(3)} ms, mean ${(total / repeat).toFixed(3)} ms ` +
+        `over ${repeat} run(s), ${nsPerFrame.toFixed(1)} ns/frame, ` +
+        `${(best / 10 / seconds).toFixed(2)}% of real time`);
+
+    if (outputPath) writeFileSync(outputPath, new Uint8Array(output.buffer));
+    if (comparePath && !compareOutput(comparePath, output, tolerance)) return 3;
+    return 0;
+}
+
+process.exitCode = main(process.argv.slice(2));
@@ -0,0 +1,99 @@
+// API en C do VocoderProcessor para a versión web (WebAssembly).
+//
+// Cada instancia do módulo ten un só procesador, como o motor da app
+// (vocoder_jni.cpp). O AudioWorklet (js/vocoder-worklet.js) e o replay
+// de Node (wasm/replay.mjs) escriben o modulador no buffer de entrada,
+// chaman a vocoder_process e len a saída estéreo intercalada.
+
+#include "ParameterMailbox.h"
+#include "SampleReader.h"
+#include "VocoderProcessor.h"
+#include <vector>
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten/emscripten.h>
+#define VOCODER_WASM_EXPORT extern "C" EMSCRIPTEN_KEEPALIVE
+#else
+#define VOCODER_WASM_EXPORT extern "C"
+#endif
+
+namespace {
+
+// Frames máximos por chamada (os bloques das sesións capturadas caben)
+constexpr int kMaxIoFrames = 4096;
+
+struct WasmVocoder {
+  explicit WasmVocoder(float sampleRate) : processor(sampleRate) {}
+
+  VocoderProcessor processor;
+  SampleReader carrierReader;
+  std::vector<int16_t> carrier;
+  std::array<float, kMaxIoFrames> input{};
+  std::array<float, kMaxIoFrames * VocoderProcessor::kOutputChannels> output{};
+};
+
+WasmVocoder *vocoder = nullptr;
+
+} // namespace
+
+VOCODER_WASM_EXPORT int vocoder_create(float sampleRate) {
+  if (vocoder == nullptr) {
+    vocoder = new WasmVocoder(sampleRate);
+  }
+  return 1;
+}
+
+VOCODER_WASM_EXPORT void vocoder_destroy() {
+  if (vocoder != nullptr) {
+    delete vocoder;
+    vocoder = nullptr;
+  }
+}
+
+VOCODER_WASM_EXPORT int vocoder_max_frames() { return kMaxIoFrames; }
+
+VOCODER_WASM_EXPORT float *vocoder_input() {
+  return vocoder != nullptr ? vocoder->input.data() : nullptr;
+}
+
+VOCODER_WASM_EXPORT float *vocoder_output() {
+  return vocoder != nullptr ? vocoder->output.data() : nullptr;
+}
+
+// Mesmo cambio empaquetado que usan o motor e as sesións (ParamChange)
+VOCODER_WASM_EXPORT void vocoder_set_param(int id, int index, int a, int b,
+                                           float value) {
+  if (vocoder == nullptr || id < 0 || id >= static_cast<int>(ParamId::Count) ||
+      !isValidParamChange(static_cast<ParamId>(id), index, a, b))
+    return;
+  ParamChange change{static_cast<ParamId>(id), static_cast<uint8_t>(index),
+                     static_cast<int8_t>(a), static_cast<int8_t>(b), value};
+  applyParamChange(vocoder->processor, change);
+}
+
+// Reserva o carrier externo e devolve onde escribir numSamples int16
+VOCODER_WASM_EXPORT int16_t *vocoder_load_carrier(int numSamples) {
+  if (vocoder == nullptr || numSamples <= 0)
+    return nullptr;
+  vocoder->carrier.assign(numSamples, 0);
+  vocoder->carrierReader.setSource(vocoder->carrier.data(), numSamples);
+  return vocoder->carrier.data();
+}
+
+VOCODER_WASM_EXPORT void vocoder_set_carrier_position(double position) {
+  if (vocoder != nullptr) {
+    vocoder->carrierReader.setPosition(position);
+  }
+}
+
+// useCarrier: 0 = oscilador interno, 1 = carrier externo cargado
+VOCODER_WASM_EXPORT void vocoder_process(int numFrames, int useCarrier) {
+  if (vocoder == nullptr || numFrames <= 0 || numFrames > kMaxIoFrames)
+    return;
+  SampleReader *extCarrier = nullptr;
+  if (useCarrier != 0 && !vocoder->carrier.empty()) {
+    extCarrier = &vocoder->carrierReader;
+  }
+  vocoder->processor.process(vocoder->input.data(), extCarrier,
+                             vocoder->output.data(), numFrames);
+}